@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace hftbattle {
+namespace bench {
+
+// Результат замера одной стадии.
+struct StageResult {
+  std::string stage;
+  std::string dataset;
+  int64_t events;
+  double seconds;
+
+  double events_per_second() const {
+    return seconds > 0 ? static_cast<double>(events) / seconds : 0.0;
+  }
+};
+
+// Не дает компилятору выбросить вычисление значения @value.
+template <typename T>
+inline void do_not_optimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * BenchmarkRunner замеряет пропускную способность (событий в секунду) отдельных стадий.
+ * Каждая стадия запускается несколько раз, в результат идет лучший запуск.
+ * Результаты печатаются в машиночитаемом виде: по одному JSON-объекту на строку.
+ **/
+class BenchmarkRunner {
+public:
+  explicit BenchmarkRunner(int repeats) : repeats_(std::max(repeats, 1)) {}
+
+  // Замеряет стадию @stage на данных @dataset.
+  // @body обрабатывает события и возвращает их количество.
+  template <typename Body>
+  void run(const std::string& stage, const std::string& dataset, Body body) {
+    StageResult result{stage, dataset, 0, 0.0};
+    for (int i = 0; i < repeats_; ++i) {
+      const auto start = std::chrono::steady_clock::now();
+      const int64_t events = body();
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      if (i == 0 || elapsed.count() < result.seconds) {
+        result.events = events;
+        result.seconds = elapsed.count();
+      }
+    }
+    results_.push_back(result);
+  }
+
+  const std::vector<StageResult>& results() const {
+    return results_;
+  }
+
+  void print_json(FILE* out) const {
+    for (const StageResult& result : results_) {
+      fprintf(out, "{\"stage\": \"%s\", \"dataset\": \"%s\", \"events\": %lld, "
+                   "\"seconds\": %.6f, \"events_per_second\": %.1f}\n",
+              result.stage.c_str(), result.dataset.c_str(), static_cast<long long>(result.events),
+              result.seconds, result.events_per_second());
+    }
+  }
+
+private:
+  const int repeats_;
+  std::vector<StageResult> results_;
+};
+
+}  // namespace bench
+}  // namespace hftbattle
@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include "./benchmark.h"
+#include "./synthetic_market.h"
+#include "depth_profile.h"
+#include "order_book.h"
+#include "base/decimal_parser.h"
+#include "base/string_stream.h"
+#include "base/stream_merger.h"
+#include "base/varint.h"
+
+using namespace hftbattle;
+using namespace hftbattle::bench;
+
+/**
+ * Замеры пропускной способности отдельных стадий обработки биржевых данных.
+ * Запуск: replay_benchmark [--events N] [--repeats R] [--output file]
+ * Результат - по одной JSON-строке на стадию (в stdout или в файл --output).
+ **/
+
+namespace {
+
+const Price kMinStep = 0.25_dc;
+const int32_t kBookDepth = 10;
+
+// Стакан, изменяемый напрямую по уровням, в обход разбора биржевых записей.
+class BenchOrderBook : public OrderBook {
+public:
+  BenchOrderBook() : OrderBook(0, kBookDepth) {}
+
+  void set_level(Dir dir, Price price, Amount volume) {
+    auto it = quotes_[dir].find(price);
+    if (volume == 0) {
+      if (it != quotes_[dir].end()) {
+        quotes_[dir].erase(it);
+      }
+      return;
+    }
+    if (it == quotes_[dir].end()) {
+      it = quotes_[dir].emplace(price, create_quote(dir, price)).first;
+    }
+    Quote* quote = it->second.get();
+    modify_quote_volume(quote, volume - quote->get_volume());
+  }
+};
+
+// Поток заранее сгенерированных событий для слияния в StreamMerger.
+class EventsStream {
+public:
+  explicit EventsStream(const std::vector<SyntheticEvent>* events) : events_(events) {}
+
+  bool empty() const { return pos_ >= events_->size(); }
+  EventOrderKey front_key() const { return (*events_)[pos_].key; }
+  void pop() { ++pos_; }
+
+private:
+  const std::vector<SyntheticEvent>* events_;
+  size_t pos_ = 0;
+};
+
+int64_t bench_book_update(const std::vector<SyntheticEvent>& events) {
+  BenchOrderBook book;
+  int64_t updates = 0;
+  for (const auto& event : events) {
+    if (event.type == SyntheticEventType::BookUpdate) {
+      book.set_level(event.dir, event.price, event.amount);
+      ++updates;
+    }
+  }
+  do_not_optimize(book.quotes_count(BID));
+  return updates;
+}
+
+int64_t bench_snapshot_build(const std::vector<SyntheticEvent>& events) {
+  BenchOrderBook book;
+  for (int32_t level = 0; level < kBookDepth; ++level) {
+    book.set_level(BID, Price(2000) - kMinStep * level, 100);
+    book.set_level(ASK, Price(2000) + kMinStep * (level + 1), 100);
+  }
+  OrderBook snapshot(0, kBookDepth);
+  for (const auto& event : events) {
+    book.build_snapshot(&snapshot);
+    do_not_optimize(event);
+  }
+  do_not_optimize(snapshot.quotes_count(ASK));
+  return static_cast<int64_t>(events.size());
+}
+
+// Перестроение профиля глубины и запросы к нему на каждом апдейте стакана.
+int64_t bench_depth_profile(const std::vector<SyntheticEvent>& events) {
+  BenchOrderBook book;
+  DepthProfile profile;
+  int64_t updates = 0;
+  for (const auto& event : events) {
+    if (event.type != SyntheticEventType::BookUpdate) {
+      continue;
+    }
+    book.set_level(event.dir, event.price, event.amount);
+    profile.update(book);
+    do_not_optimize(profile.volume_within_steps(BID, 3, kMinStep));
+    do_not_optimize(profile.price_for_volume(ASK, 100));
+    do_not_optimize(profile.notional_for_volume(ASK, 100));
+    ++updates;
+  }
+  return updates;
+}
+
+int64_t bench_stream_merge(const std::vector<std::vector<SyntheticEvent>>& streams_events) {
+  std::vector<EventsStream> streams;
+  streams.reserve(streams_events.size());
+  StreamMerger<EventsStream> merger;
+  for (const auto& events : streams_events) {
+    streams.emplace_back(&events);
+    merger.add_stream(&streams.back());
+  }
+  int64_t events = 0;
+  while (!merger.empty()) {
+    do_not_optimize(merger.top_index());
+    merger.pop();
+    ++events;
+  }
+  return events;
+}
+
+int64_t bench_price_format(const std::vector<SyntheticEvent>& events) {
+  StringStream stream;
+  stream.reserve(1 << 16);
+  for (const auto& event : events) {
+    stream << event.price << '\t' << event.amount << '\n';
+    if (stream.size() > (1 << 15)) {
+      stream.clear();
+    }
+  }
+  do_not_optimize(stream.size());
+  return static_cast<int64_t>(events.size());
+}
+
+// Записывает цены событий @events текстом, по одной в строке.
+std::vector<char> format_events_prices(const std::vector<SyntheticEvent>& events) {
+  StringStream stream;
+  for (const auto& event : events) {
+    stream << event.price << '\n';
+  }
+  return std::move(stream.buffer());
+}
+
+int64_t bench_price_parse(const std::vector<char>& text) {
+  const char* itr = text.data();
+  const char* end = text.data() + text.size();
+  int64_t count = 0;
+  int64_t failures = 0;
+  Decimal price;
+  while (itr != end) {
+    const char* parsed = parse_decimal(itr, end, &price);
+    if (!parsed) {
+      ++failures;
+      parsed = std::find(itr, end, '\n');
+    } else {
+      ++count;
+    }
+    itr = parsed == end ? end : parsed + 1;
+  }
+  if (failures > 0) {
+    fprintf(stderr, "price_parse: %lld unparsable lines\n", static_cast<long long>(failures));
+  }
+  do_not_optimize(price);
+  return count;
+}
+
+// Кодирует объемы и приращения цен событий @events в varint.
+std::vector<uint8_t> encode_events_varints(const std::vector<SyntheticEvent>& events) {
+  std::vector<uint8_t> buffer(events.size() * 2 * 10);
+  uint8_t* out = buffer.data();
+  int64_t last_price = 0;
+  for (const auto& event : events) {
+    const int64_t price = event.price.get_numerator() / kMinStep.get_numerator();
+    out = write_varint(zigzag_encode(price - last_price), out);
+    out = write_varint(static_cast<uint64_t>(event.amount), out);
+    last_price = price;
+  }
+  buffer.resize(static_cast<size_t>(out - buffer.data()));
+  return buffer;
+}
+
+int64_t bench_varint_decode(const std::vector<uint8_t>& buffer, std::vector<uint32_t>* values) {
+  const uint8_t* end = buffer.data() + buffer.size();
+  const uint8_t* in = read_varint_vector(buffer.data(), end, values->data(), values->size());
+  do_not_optimize(in);
+  return static_cast<int64_t>(values->size());
+}
+
+// Побайтовое декодирование с проверкой границ на каждом байте - точка отсчета для varint_decode.
+int64_t bench_varint_decode_checked(const std::vector<uint8_t>& buffer, std::vector<uint32_t>* values) {
+  const uint8_t* in = buffer.data();
+  const uint8_t* end = buffer.data() + buffer.size();
+  for (auto& value : *values) {
+    uint64_t result = 0;
+    in = impl::read_varint_checked(in, end, &result);
+    value = static_cast<uint32_t>(result);
+  }
+  do_not_optimize(in);
+  return static_cast<int64_t>(values->size());
+}
+
+int print_usage(const char* program) {
+  fprintf(stderr, "usage: %s [--events N] [--repeats R] [--output file]\n", program);
+  return 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t events = 1000000;
+  int repeats = 3;
+  const char* output = nullptr;
+  for (int i = 1; i < argc; i += 2) {
+    if (i + 1 == argc) {
+      fprintf(stderr, "missing value for option: %s\n", argv[i]);
+      return print_usage(argv[0]);
+    }
+    const char* value = argv[i + 1];
+    if (!strcmp(argv[i], "--events")) {
+      events = static_cast<size_t>(atoll(value));
+    } else if (!strcmp(argv[i], "--repeats")) {
+      repeats = atoi(value);
+    } else if (!strcmp(argv[i], "--output")) {
+      output = value;
+    } else {
+      fprintf(stderr, "unknown option: %s\n", argv[i]);
+      return print_usage(argv[0]);
+    }
+  }
+
+  Ticks::init();
+  SyntheticMarketConfig config;
+  config.events_count = events;
+  config.book_depth = kBookDepth;
+  config.min_step = kMinStep;
+  const auto market_events = generate_market_events(config);
+  const int32_t kStreamsCount = 8;
+  std::vector<std::vector<SyntheticEvent>> streams_events;
+  for (int32_t security = 0; security < kStreamsCount; ++security) {
+    SyntheticSecurityStream stream(config, security, events / kStreamsCount);
+    streams_events.emplace_back();
+    for (; !stream.empty(); stream.pop()) {
+      streams_events.back().push_back(stream.front());
+    }
+  }
+
+  BenchmarkRunner runner(repeats);
+  runner.run("book_update", "synthetic", [&] { return bench_book_update(market_events); });
+  runner.run("snapshot_build", "synthetic", [&] { return bench_snapshot_build(market_events); });
+  runner.run("depth_profile", "synthetic", [&] { return bench_depth_profile(market_events); });
+  runner.run("stream_merge", "synthetic_8_streams", [&] { return bench_stream_merge(streams_events); });
+  runner.run("price_format", "synthetic", [&] { return bench_price_format(market_events); });
+  const auto prices_text = format_events_prices(market_events);
+  runner.run("price_parse", "synthetic", [&] { return bench_price_parse(prices_text); });
+  const auto varints = encode_events_varints(market_events);
+  std::vector<uint32_t> decoded(market_events.size() * 2);
+  runner.run("varint_decode", "synthetic", [&] { return bench_varint_decode(varints, &decoded); });
+  runner.run("varint_decode_checked", "synthetic", [&] {
+    return bench_varint_decode_checked(varints, &decoded);
+  });
+
+  FILE* out = output ? fopen(output, "w") : stdout;
+  if (!out) {
+    fprintf(stderr, "can't open %s\n", output);
+    return 1;
+  }
+  runner.print_json(out);
+  if (out != stdout) {
+    fclose(out);
+  }
+  return 0;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "base/common_enums.h"
+#include "base/constants.h"
+#include "base/stream_merger.h"
+
+namespace hftbattle {
+namespace bench {
+
+// Быстрый детерминированный генератор псевдослучайных чисел (xorshift64*).
+class XorShift {
+public:
+  explicit XorShift(uint64_t seed) : state_(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+  uint64_t next() {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * 0x2545F4914F6CDD1DULL;
+  }
+
+  // Равномерно распределенное число в [0, 1).
+  double uniform() {
+    return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+  }
+
+  // Равномерно распределенное целое число в [lo, hi].
+  int32_t uniform_int(int32_t lo, int32_t hi) {
+    return lo + static_cast<int32_t>(next() % static_cast<uint64_t>(hi - lo + 1));
+  }
+
+private:
+  uint64_t state_;
+};
+
+// Параметры синтетических биржевых данных.
+struct SyntheticMarketConfig {
+  // Общее количество событий по всем инструментам.
+  size_t events_count = 1000000;
+  // Средний темп событий по одному инструменту (событий в секунду).
+  double events_per_second = 50000.0;
+  // Количество инструментов.
+  int32_t securities_count = 1;
+  // Глубина стакана каждого инструмента.
+  int32_t book_depth = 10;
+  // Шаг цены и начальная лучшая цена на покупку.
+  Price min_step = Price(0.25);
+  Price start_price = Price(2000);
+  // Вероятность того, что событие сдвигает лучшие цены на один шаг (волатильность).
+  double price_move_probability = 0.01;
+  // Вероятность того, что событие начинает серию сделок, и максимальный размер серии.
+  double deal_burst_probability = 0.02;
+  int32_t max_deal_burst_size = 20;
+  // Задержка между биржевым и локальным временем, в наносекундах.
+  int64_t feed_latency_ns = 20000;
+  uint64_t seed = 1;
+};
+
+enum class SyntheticEventType : uint8_t {
+  BookUpdate,
+  Deal
+};
+
+// Синтетическое биржевое событие. Для BookUpdate @amount - новый объем уровня
+// (0 - уровень удален), для Deal - объем сделки, @dir - направление агрессора.
+// В ключе @key tsc - локальное время, moment - биржевое время, оба в наносекундах.
+struct SyntheticEvent {
+  EventOrderKey key;
+  int32_t security;
+  SyntheticEventType type;
+  Dir dir;
+  Price price;
+  Amount amount;
+};
+
+/**
+ * SyntheticSecurityStream лениво порождает упорядоченный по времени поток событий
+ * одного инструмента: изменения уровней стакана (чаще около лучших цен), случайное
+ * блуждание лучших цен и серии сделок по лучшей цене. Интервалы между событиями
+ * распределены экспоненциально со средним 1 / events_per_second.
+ * Поток удовлетворяет требованиям StreamMerger.
+ **/
+class SyntheticSecurityStream {
+public:
+  SyntheticSecurityStream(const SyntheticMarketConfig& config, int32_t security, size_t events_count)
+    : config_(config),
+      rng_(config.seed * 7919 + static_cast<uint64_t>(security) + 1),
+      security_(security),
+      events_left_(events_count),
+      best_bid_steps_(static_cast<int64_t>(config.start_price.get_numerator() /
+                                           config.min_step.get_numerator())) {
+    if (events_left_ > 0) {
+      generate_next();
+    }
+  }
+
+  bool empty() const {
+    return events_left_ == 0;
+  }
+
+  EventOrderKey front_key() const {
+    return current_.key;
+  }
+
+  const SyntheticEvent& front() const {
+    return current_;
+  }
+
+  void pop() {
+    if (--events_left_ > 0) {
+      generate_next();
+    }
+  }
+
+private:
+  void generate_next() {
+    if (burst_left_ > 0) {
+      --burst_left_;
+      moment_ns_ += rng_.uniform_int(1, 500);
+      const Dir passive_dir = opposite_dir(burst_dir_);
+      set_event(SyntheticEventType::Deal, burst_dir_, level_price(passive_dir, 0), rng_.uniform_int(1, 10));
+      return;
+    }
+    const double u = std::max(rng_.uniform(), 1e-12);
+    moment_ns_ += 1 + static_cast<int64_t>(-std::log(u) * 1e9 / config_.events_per_second);
+    if (rng_.uniform() < config_.price_move_probability) {
+      best_bid_steps_ += (rng_.next() & 1) ? 1 : -1;
+    }
+    if (rng_.uniform() < config_.deal_burst_probability) {
+      burst_dir_ = static_cast<Dir>(rng_.next() & 1);
+      burst_left_ = rng_.uniform_int(1, std::max(config_.max_deal_burst_size, 1)) - 1;
+      const Dir passive_dir = opposite_dir(burst_dir_);
+      set_event(SyntheticEventType::Deal, burst_dir_, level_price(passive_dir, 0), rng_.uniform_int(1, 10));
+      return;
+    }
+    const Dir dir = static_cast<Dir>(rng_.next() & 1);
+    const int32_t depth = std::max(config_.book_depth, 1);
+    const int32_t level = std::min(rng_.uniform_int(0, depth - 1), rng_.uniform_int(0, depth - 1));
+    const Amount volume = rng_.uniform_int(0, 9) == 0 ? 0 : rng_.uniform_int(1, 500);
+    set_event(SyntheticEventType::BookUpdate, dir, level_price(dir, level), volume);
+  }
+
+  Price level_price(Dir dir, int32_t level) const {
+    const int64_t steps = dir == BID ? best_bid_steps_ - level : best_bid_steps_ + 1 + level;
+    return config_.min_step * steps;
+  }
+
+  void set_event(SyntheticEventType type, Dir dir, Price price, Amount amount) {
+    const EventOrderKey key{moment_ns_ + config_.feed_latency_ns, moment_ns_};
+    current_ = SyntheticEvent{key, security_, type, dir, price, amount};
+  }
+
+  const SyntheticMarketConfig& config_;
+  XorShift rng_;
+  const int32_t security_;
+  size_t events_left_;
+  int64_t best_bid_steps_;
+  int64_t moment_ns_ = 0;
+  int32_t burst_left_ = 0;
+  Dir burst_dir_ = BID;
+  SyntheticEvent current_;
+};
+
+// Вызывает @callback для каждого события всех инструментов из @config в порядке времени.
+// События порождаются по одному, без накопления всего потока в памяти.
+template <typename Callback>
+void for_each_market_event(const SyntheticMarketConfig& config, Callback callback) {
+  const int32_t securities_count = std::max(config.securities_count, 1);
+  std::vector<SyntheticSecurityStream> streams;
+  streams.reserve(static_cast<size_t>(securities_count));
+  StreamMerger<SyntheticSecurityStream> merger;
+  for (int32_t security = 0; security < securities_count; ++security) {
+    const size_t events_count = config.events_count / securities_count +
+        (static_cast<size_t>(security) < config.events_count % securities_count ? 1 : 0);
+    streams.emplace_back(config, security, events_count);
+    merger.add_stream(&streams.back());
+  }
+  while (!merger.empty()) {
+    callback(merger.top()->front());
+    merger.pop();
+  }
+}
+
+// Порождает события всех инструментов из @config, слитые в один поток по времени.
+inline std::vector<SyntheticEvent> generate_market_events(const SyntheticMarketConfig& config) {
+  std::vector<SyntheticEvent> events;
+  events.reserve(config.events_count);
+  for_each_market_event(config, [&events](const SyntheticEvent& event) { events.push_back(event); });
+  return events;
+}
+
+}  // namespace bench
+}  // namespace hftbattle
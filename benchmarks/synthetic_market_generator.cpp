@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "./synthetic_market.h"
+#include "base/string_stream.h"
+
+using namespace hftbattle;
+using namespace hftbattle::bench;
+
+/**
+ * Генератор синтетических биржевых данных для нагрузочного тестирования.
+ * Запуск: synthetic_market_generator --output file [--events N] [--rate events_per_second]
+ *   [--securities K] [--depth D] [--volatility p] [--burst-probability p] [--max-burst B] [--seed S]
+ * Пишет события всех инструментов, упорядоченные по времени, в TSV-файл с колонками
+ * tsc, moment, security, type, dir, price, amount (см. SyntheticEvent).
+ **/
+
+namespace {
+
+// Пишет события по мере их порождения, не держа весь поток в памяти.
+void write_events(const SyntheticMarketConfig& config, FILE* out) {
+  StringStream stream;
+  stream.reserve(1 << 17);
+  stream << "tsc\tmoment\tsecurity\ttype\tdir\tprice\tamount\n";
+  for_each_market_event(config, [&stream, out](const SyntheticEvent& event) {
+    stream << event.key.tsc << '\t' << event.key.moment << '\t' << event.security << '\t'
+           << (event.type == SyntheticEventType::Deal ? "deal" : "book") << '\t'
+           << (event.dir == BID ? "bid" : "ask") << '\t' << event.price << '\t' << event.amount << '\n';
+    if (stream.size() > (1 << 16)) {
+      fwrite(stream.data(), 1, stream.size(), out);
+      stream.clear();
+    }
+  });
+  fwrite(stream.data(), 1, stream.size(), out);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  SyntheticMarketConfig config;
+  const char* output = nullptr;
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const char* value = argv[i + 1];
+    if (!strcmp(argv[i], "--output")) {
+      output = value;
+    } else if (!strcmp(argv[i], "--events")) {
+      config.events_count = static_cast<size_t>(atoll(value));
+    } else if (!strcmp(argv[i], "--rate")) {
+      config.events_per_second = atof(value);
+    } else if (!strcmp(argv[i], "--securities")) {
+      config.securities_count = atoi(value);
+    } else if (!strcmp(argv[i], "--depth")) {
+      config.book_depth = atoi(value);
+    } else if (!strcmp(argv[i], "--volatility")) {
+      config.price_move_probability = atof(value);
+    } else if (!strcmp(argv[i], "--burst-probability")) {
+      config.deal_burst_probability = atof(value);
+    } else if (!strcmp(argv[i], "--max-burst")) {
+      config.max_deal_burst_size = atoi(value);
+    } else if (!strcmp(argv[i], "--seed")) {
+      config.seed = static_cast<uint64_t>(atoll(value));
+    } else {
+      fprintf(stderr, "unknown option: %s\n", argv[i]);
+      return 1;
+    }
+  }
+  if (!output || config.events_per_second <= 0) {
+    fprintf(stderr, "usage: %s --output file [--events N] [--rate events_per_second] [--securities K] "
+                    "[--depth D] [--volatility p] [--burst-probability p] [--max-burst B] [--seed S]\n",
+            argv[0]);
+    return 1;
+  }
+  FILE* out = fopen(output, "w");
+  if (!out) {
+    fprintf(stderr, "can't open %s\n", output);
+    return 1;
+  }
+  write_events(config, out);
+  fclose(out);
+  return 0;
+}
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "./contest_book_info.h"
+#include "./deal.h"
+#include "./execution_report.h"
+#include "base/log.h"
+#include "base/spsc_queue.h"
+
+namespace hftbattle {
+
+/**
+ * Событие симуляции для аналитики: компактная копия без указателей, которую можно
+ * передать в другой поток. Заполнены только поля, относящиеся к типу события.
+ **/
+struct AnalyticsEvent {
+  enum class Type : uint8_t {
+    // Новый стакан торгового инструмента: лучшие цены и объемы.
+    BookUpdate,
+    // Сделка торгового инструмента: dir - направление налетающей заявки.
+    Deal,
+    // Сделка с участием нашей заявки: dir - направление нашей заявки.
+    Execution,
+    // Конец симуляции.
+    Finished
+  };
+
+  Type type;
+  Dir dir;
+  Microseconds server_time;
+  Price price;
+  Amount amount;
+  std::array<Price, 2> best_prices;
+  std::array<Amount, 2> best_volumes;
+
+  // Есть ли в стакане котировки с обеих сторон (для событий BookUpdate).
+  // Пустая сторона имеет нулевой объем и цену по умолчанию (default_quote_price).
+  bool has_middle_price() const {
+    return best_volumes[BID] > 0 && best_volumes[ASK] > 0;
+  }
+
+  // Средняя цена лучших котировок (для событий BookUpdate). Имеет смысл, только если
+  // has_middle_price().
+  Price middle_price() const {
+    return (best_prices[BID] + best_prices[ASK]) / 2;
+  }
+};
+
+/**
+ * Модуль аналитики, подписанный на события AnalyticsBus.
+ * Все методы вызываются в потоке шины, а не в потоке стратегии.
+ **/
+class AnalyticsPlugin {
+public:
+  virtual ~AnalyticsPlugin() {}
+
+  virtual void book_update(const AnalyticsEvent& event) {}
+  virtual void deal(const AnalyticsEvent& event) {}
+  virtual void execution(const AnalyticsEvent& event) {}
+  // Вызывается после последнего события.
+  virtual void finish() {}
+};
+
+/**
+ * AnalyticsBus выносит аналитику (маркауты, разбор исполнений, учет позиции) из колбэков
+ * стратегии в отдельный поток. Стратегия публикует события (publish_*) - это копирование
+ * нескольких полей в очередь без блокировок (SpscQueue); поток шины разбирает очередь
+ * и раздает события модулям (AnalyticsPlugin) в порядке публикации.
+ *
+ * Стаканы и сделки инструмента - снимки, потеря которых не портит результаты модулей:
+ * если очередь заполнена, такое событие отбрасывается и учитывается в dropped_count.
+ * Наши сделки (publish_execution) и конец симуляции отбрасывать нельзя - от них зависят
+ * позиция и маркауты, поэтому при заполненной очереди поток стратегии ждет, пока поток
+ * шины освободит место. Размер очереди задается в конструкторе.
+ *
+ * Модули добавляются до start. После stop поток шины завершен, и результаты модулей
+ * можно читать из потока стратегии, например в деструкторе стратегии:
+ *
+ *   auto markouts = bus_.add_plugin<MarkoutPlugin>(horizons);
+ *   bus_.start();
+ *   ...
+ *   bus_.publish_book(get_server_time(), trading_book_info);
+ *   ...
+ *   bus_.stop();
+ **/
+class AnalyticsBus {
+public:
+  explicit AnalyticsBus(size_t queue_capacity = 1 << 16) : queue_(queue_capacity) {
+  }
+
+  AnalyticsBus(const AnalyticsBus&) = delete;
+  AnalyticsBus& operator=(const AnalyticsBus&) = delete;
+
+  ~AnalyticsBus() {
+    stop();
+  }
+
+  // Создает модуль типа @Plugin с аргументами конструктора @args и подписывает его на события.
+  // Возвращает указатель на модуль; модулем владеет шина.
+  template <typename Plugin, typename... Args>
+  Plugin* add_plugin(Args&&... args) {
+    CHECK(!thread_.joinable()) << "plugins must be added before start";
+    plugins_.emplace_back(new Plugin(std::forward<Args>(args)...));
+    return static_cast<Plugin*>(plugins_.back().get());
+  }
+
+  // Запускает поток шины.
+  void start() {
+    CHECK(!thread_.joinable()) << "analytics bus is already started";
+    thread_ = std::thread([this] { run(); });
+  }
+
+  // Публикует событие конца симуляции и дожидается, пока модули обработают все события.
+  void stop() {
+    if (!thread_.joinable()) {
+      return;
+    }
+    AnalyticsEvent event = {};
+    event.type = AnalyticsEvent::Type::Finished;
+    push(event);
+    thread_.join();
+  }
+
+  void publish_book(Microseconds server_time, const ContestBookInfo& book_info) {
+    AnalyticsEvent event = {};
+    event.type = AnalyticsEvent::Type::BookUpdate;
+    event.server_time = server_time;
+    for (Dir dir : {BID, ASK}) {
+      event.best_prices[dir] = book_info.best_price(dir);
+      event.best_volumes[dir] = book_info.best_volume(dir);
+    }
+    publish(event);
+  }
+
+  void publish_deals(const std::vector<Deal>& deals) {
+    for (const auto& deal : deals) {
+      AnalyticsEvent event = {};
+      event.type = AnalyticsEvent::Type::Deal;
+      event.dir = deal.dir;
+      event.server_time = deal.server_time;
+      event.price = deal.price;
+      event.amount = deal.amount;
+      publish(event);
+    }
+  }
+
+  void publish_execution(const ExecutionReport& execution_report) {
+    AnalyticsEvent event = {};
+    event.type = AnalyticsEvent::Type::Execution;
+    event.dir = execution_report.dir();
+    event.server_time = execution_report.server_time();
+    event.price = execution_report.deal_price();
+    event.amount = execution_report.deal_amount();
+    push(event);
+  }
+
+  // Количество стаканов и сделок инструмента, отброшенных из-за заполненной очереди.
+  // Наши сделки не отбрасываются.
+  int64_t dropped_count() const {
+    return dropped_count_;
+  }
+
+private:
+  // Пока очередь пуста, поток шины сначала проверяет ее в цикле, затем уступает процессор,
+  // а при долгом простое засыпает, чтобы не занимать ядро между событиями.
+  static const int32_t kSpinsBeforeYield = 1000;
+  static const int32_t kSpinsBeforeSleep = 10000;
+
+  void publish(const AnalyticsEvent& event) {
+    if (!queue_.try_push(event)) {
+      ++dropped_count_;
+    }
+  }
+
+  // Добавляет событие в очередь, дожидаясь свободного места.
+  void push(const AnalyticsEvent& event) {
+    while (!queue_.try_push(event)) {
+      CHECK(thread_.joinable()) << "analytics queue is full and the bus is not started";
+      std::this_thread::yield();
+    }
+  }
+
+  void run() {
+    AnalyticsEvent event;
+    int32_t spins = 0;
+    while (true) {
+      if (!queue_.try_pop(&event)) {
+        if (spins >= kSpinsBeforeSleep) {
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+        } else if (++spins >= kSpinsBeforeYield) {
+          std::this_thread::yield();
+        }
+        continue;
+      }
+      spins = 0;
+      switch (event.type) {
+        case AnalyticsEvent::Type::BookUpdate:
+          for (auto& plugin : plugins_) {
+            plugin->book_update(event);
+          }
+          break;
+        case AnalyticsEvent::Type::Deal:
+          for (auto& plugin : plugins_) {
+            plugin->deal(event);
+          }
+          break;
+        case AnalyticsEvent::Type::Execution:
+          for (auto& plugin : plugins_) {
+            plugin->execution(event);
+          }
+          break;
+        case AnalyticsEvent::Type::Finished:
+          for (auto& plugin : plugins_) {
+            plugin->finish();
+          }
+          return;
+      }
+    }
+  }
+
+  SpscQueue<AnalyticsEvent> queue_;
+  std::vector<std::unique_ptr<AnalyticsPlugin>> plugins_;
+  std::thread thread_;
+  // Изменяется только потоком стратегии.
+  int64_t dropped_count_ = 0;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "./analytics_bus.h"
+#include "base/ring_buffer.h"
+
+namespace hftbattle {
+
+/**
+ * MarkoutPlugin - маркауты наших сделок: насколько средняя цена стакана через заданные
+ * интервалы после сделки ушла в нашу пользу. Для покупки маркаут равен
+ * (средняя цена через интервал - цена сделки) * объем, для продажи - с обратным знаком.
+ * Средняя цена берется из первого стакана, пришедшего не раньше окончания интервала;
+ * если одна из сторон этого стакана пуста, берется средняя цена последнего стакана
+ * с обеими сторонами, а до первого такого стакана сделки ждут следующего.
+ * Сделки, интервал которых не закончился до конца симуляции, не учитываются.
+ **/
+class MarkoutPlugin : public AnalyticsPlugin {
+public:
+  // @horizons - интервалы, по возрастанию.
+  explicit MarkoutPlugin(std::vector<Microseconds> horizons)
+    : horizons_(std::move(horizons)),
+      pending_(horizons_.size()),
+      markouts_(horizons_.size(), 0),
+      volumes_(horizons_.size(), 0) {
+  }
+
+  void book_update(const AnalyticsEvent& event) override {
+    if (event.has_middle_price()) {
+      last_middle_price_ = event.middle_price().get_numerator();
+      has_middle_price_ = true;
+    }
+    if (!has_middle_price_) {
+      return;
+    }
+    const int64_t middle_price = last_middle_price_;
+    for (size_t i = 0; i < horizons_.size(); ++i) {
+      auto& pending = pending_[i];
+      while (!pending.empty() && pending.front().server_time + horizons_[i] <= event.server_time) {
+        const auto& fill = pending.front();
+        const int64_t sign = fill.dir == BID ? 1 : -1;
+        markouts_[i] += sign * (middle_price - fill.price.get_numerator()) * fill.amount;
+        volumes_[i] += fill.amount;
+        pending.pop_front();
+      }
+    }
+  }
+
+  void execution(const AnalyticsEvent& event) override {
+    for (auto& pending : pending_) {
+      pending.push_back(event);
+    }
+  }
+
+  size_t horizons_count() const {
+    return horizons_.size();
+  }
+
+  Microseconds horizon(size_t index) const {
+    return horizons_[index];
+  }
+
+  // Суммарный маркаут по интервалу с номером @index.
+  Price markout(size_t index) const {
+    return Price::from_numerator(markouts_[index]);
+  }
+
+  // Средний маркаут на лот по интервалу с номером @index.
+  Price markout_per_lot(size_t index) const {
+    return volumes_[index] == 0 ? Price() : markout(index) / volumes_[index];
+  }
+
+  // Объем сделок, учтенных в маркауте по интервалу с номером @index.
+  int64_t volume(size_t index) const {
+    return volumes_[index];
+  }
+
+private:
+  std::vector<Microseconds> horizons_;
+  // Для каждого интервала - наши сделки, интервал которых еще не закончился.
+  std::vector<RingBuffer<AnalyticsEvent>> pending_;
+  // Суммы маркаутов в единицах числителя Decimal.
+  std::vector<int64_t> markouts_;
+  std::vector<int64_t> volumes_;
+  // Средняя цена последнего стакана с обеими сторонами в единицах числителя Decimal.
+  bool has_middle_price_ = false;
+  int64_t last_middle_price_ = 0;
+};
+
+/**
+ * InventoryPlugin - учет позиции по нашим сделкам: текущая и максимальная по модулю
+ * позиция и средняя по времени абсолютная позиция (время отсчитывается по событиям шины).
+ **/
+class InventoryPlugin : public AnalyticsPlugin {
+public:
+  void book_update(const AnalyticsEvent& event) override {
+    advance(event.server_time);
+  }
+
+  void deal(const AnalyticsEvent& event) override {
+    advance(event.server_time);
+  }
+
+  void execution(const AnalyticsEvent& event) override {
+    advance(event.server_time);
+    position_ += event.dir == BID ? event.amount : -event.amount;
+    max_abs_position_ = std::max(max_abs_position_, std::abs(position_));
+    ++executions_count_;
+  }
+
+  int64_t position() const {
+    return position_;
+  }
+
+  int64_t max_abs_position() const {
+    return max_abs_position_;
+  }
+
+  int64_t executions_count() const {
+    return executions_count_;
+  }
+
+  // Средняя по времени абсолютная позиция.
+  double average_abs_position() const {
+    const int64_t duration = (last_time_ - first_time_).count();
+    return duration > 0 ? static_cast<double>(abs_position_time_) / duration : static_cast<double>(std::abs(position_));
+  }
+
+private:
+  void advance(Microseconds server_time) {
+    if (!started_) {
+      started_ = true;
+      first_time_ = last_time_ = server_time;
+      return;
+    }
+    if (server_time > last_time_) {
+      abs_position_time_ += std::abs(position_) * (server_time - last_time_).count();
+      last_time_ = server_time;
+    }
+  }
+
+  bool started_ = false;
+  Microseconds first_time_{0};
+  Microseconds last_time_{0};
+  int64_t position_ = 0;
+  int64_t max_abs_position_ = 0;
+  int64_t executions_count_ = 0;
+  // Интеграл абсолютной позиции по времени, лоты * мкс.
+  int64_t abs_position_time_ = 0;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,586 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "base/log.h"
+#include "base/string_view.h"
+#include "base/varint.h"
+
+namespace hftbattle {
+
+/**
+ * Колоночный двоичный формат таблиц результатов (заявки, сделки, точки графиков)
+ * для последующего анализа. По сравнению с CSV:
+ * - строки таблицы хранятся блоками, внутри блока - по колонкам;
+ * - целые колонки (в том числе цены в виде числителя Decimal) кодируются приращениями
+ *   в формате zigzag + varint, строковые - словарем блока и номерами в нем;
+ * - для числовых колонок в блоке хранятся минимум и максимум, поэтому блоки, в которых
+ *   нет подходящих под условие строк, пропускаются без декодирования;
+ * - при чтении декодируются только колонки, к которым обращаются, и колонки условий.
+ *
+ * Файл: сигнатура kColumnarMagic, версия, описание колонок (тип, имя), далее блоки.
+ * Блок: размер в байтах (4 байта), число строк, для каждой колонки - размер и данные.
+ * Числа с плавающей точкой и размер блока записываются в порядке байт машины.
+ **/
+
+enum class ColumnType : uint8_t {
+  Int64,
+  Double,
+  String
+};
+
+struct ColumnSpec {
+  std::string name;
+  ColumnType type;
+};
+
+constexpr char kColumnarMagic[] = "HBCT";
+constexpr uint64_t kColumnarVersion = 1;
+
+namespace impl {
+
+inline void append_varint(std::string& out, uint64_t value) {
+  uint8_t buffer[kMaxVarintSize];
+  out.append(reinterpret_cast<const char*>(buffer), write_varint(value, buffer) - buffer);
+}
+
+template <typename T>
+inline void append_raw(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+inline const uint8_t* read_raw(const uint8_t* in, const uint8_t* end, T* value) {
+  CHECK(static_cast<size_t>(end - in) >= sizeof(T)) << "columnar table is truncated";
+  memcpy(value, in, sizeof(T));
+  return in + sizeof(T);
+}
+
+inline const uint8_t* read_varint_or_fail(const uint8_t* in, const uint8_t* end, uint64_t* value) {
+  in = read_varint(in, end, value);
+  CHECK(in) << "columnar table is corrupted";
+  return in;
+}
+
+}  // namespace impl
+
+/**
+ * ColumnarWriter пишет таблицу с колонками @columns в файл @path.
+ * Значения строки задаются по колонкам (set_int, set_double, set_string), после чего
+ * вызывается end_row. Каждые @block_rows строк блок сбрасывается в файл,
+ * остаток - в close или в деструкторе.
+ **/
+class ColumnarWriter {
+public:
+  ColumnarWriter(const std::string& path, std::vector<ColumnSpec> columns, size_t block_rows = 65536)
+    : out_(path, std::ios::binary), block_rows_(block_rows) {
+    CHECK(out_) << "can't open " << path;
+    std::string header(kColumnarMagic, sizeof(kColumnarMagic) - 1);
+    impl::append_varint(header, kColumnarVersion);
+    impl::append_varint(header, columns.size());
+    for (auto& spec : columns) {
+      header.push_back(static_cast<char>(spec.type));
+      impl::append_varint(header, spec.name.size());
+      header += spec.name;
+      columns_.emplace_back();
+      columns_.back().spec = std::move(spec);
+    }
+    out_.write(header.data(), header.size());
+  }
+
+  ColumnarWriter(const ColumnarWriter&) = delete;
+  ColumnarWriter& operator=(const ColumnarWriter&) = delete;
+
+  ~ColumnarWriter() {
+    close();
+  }
+
+  void set_int(size_t column, int64_t value) {
+    columns_[column].ints.push_back(value);
+  }
+
+  void set_double(size_t column, double value) {
+    columns_[column].doubles.push_back(value);
+  }
+
+  void set_string(size_t column, const std::string& value) {
+    Column& data = columns_[column];
+    auto it = data.dictionary_ids.find(value);
+    if (it == data.dictionary_ids.end()) {
+      it = data.dictionary_ids.emplace(value, static_cast<uint32_t>(data.dictionary.size())).first;
+      data.dictionary.push_back(value);
+    }
+    data.codes.push_back(it->second);
+  }
+
+  // Завершает строку: значения должны быть заданы для всех колонок.
+  void end_row() {
+    ++rows_;
+    for (const Column& column : columns_) {
+      CHECK(column.size() == rows_) << "value of column '" << column.spec.name << "' is not set";
+    }
+    if (rows_ >= block_rows_) {
+      flush_block();
+    }
+  }
+
+  // Сбрасывает накопленные строки и закрывает файл.
+  void close() {
+    if (!out_.is_open()) {
+      return;
+    }
+    flush_block();
+    out_.close();
+  }
+
+private:
+  struct Column {
+    ColumnSpec spec;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<uint32_t> codes;
+    std::vector<std::string> dictionary;
+    std::unordered_map<std::string, uint32_t> dictionary_ids;
+
+    size_t size() const {
+      return ints.size() + doubles.size() + codes.size();
+    }
+  };
+
+  void flush_block() {
+    if (rows_ == 0) {
+      return;
+    }
+    block_.clear();
+    impl::append_varint(block_, rows_);
+    for (Column& column : columns_) {
+      payload_.clear();
+      encode_column(column, payload_);
+      impl::append_varint(block_, payload_.size());
+      block_ += payload_;
+    }
+    std::string block_size;
+    impl::append_raw(block_size, static_cast<uint32_t>(block_.size()));
+    out_.write(block_size.data(), block_size.size());
+    out_.write(block_.data(), block_.size());
+    rows_ = 0;
+  }
+
+  static void encode_column(Column& column, std::string& out) {
+    switch (column.spec.type) {
+      case ColumnType::Int64: {
+        int64_t min = column.ints.front();
+        int64_t max = column.ints.front();
+        for (int64_t value : column.ints) {
+          min = std::min(min, value);
+          max = std::max(max, value);
+        }
+        impl::append_varint(out, zigzag_encode(min));
+        impl::append_varint(out, zigzag_encode(max));
+        int64_t previous = 0;
+        for (int64_t value : column.ints) {
+          impl::append_varint(out, zigzag_encode(static_cast<int64_t>(static_cast<uint64_t>(value) -
+                                                                      static_cast<uint64_t>(previous))));
+          previous = value;
+        }
+        column.ints.clear();
+        break;
+      }
+      case ColumnType::Double: {
+        double min = column.doubles.front();
+        double max = column.doubles.front();
+        for (double value : column.doubles) {
+          min = std::min(min, value);
+          max = std::max(max, value);
+        }
+        impl::append_raw(out, min);
+        impl::append_raw(out, max);
+        out.append(reinterpret_cast<const char*>(column.doubles.data()), column.doubles.size() * sizeof(double));
+        column.doubles.clear();
+        break;
+      }
+      case ColumnType::String: {
+        impl::append_varint(out, column.dictionary.size());
+        for (const std::string& value : column.dictionary) {
+          impl::append_varint(out, value.size());
+          out += value;
+        }
+        for (uint32_t code : column.codes) {
+          impl::append_varint(out, code);
+        }
+        column.codes.clear();
+        column.dictionary.clear();
+        column.dictionary_ids.clear();
+        break;
+      }
+    }
+  }
+
+  std::ofstream out_;
+  const size_t block_rows_;
+  std::vector<Column> columns_;
+  size_t rows_ = 0;
+  std::string block_;
+  std::string payload_;
+};
+
+/**
+ * ColumnarReader читает таблицу, записанную ColumnarWriter, поблочно.
+ * Перед чтением можно задать условия на значения (where_between для числовых колонок,
+ * where_equal для строковых). Блоки, которые по статистике (минимум и максимум числовой
+ * колонки) или словарю строковой колонки не содержат подходящих строк, пропускаются
+ * целиком: для проверки строкового условия читается только словарь блока. Колонка блока декодируется при первом
+ * обращении к ней, поэтому остальные колонки не декодируются вовсе.
+ *
+ * Пример:
+ *   ColumnarReader reader("deals.hbct");
+ *   reader.where_between("server_time", from, to);
+ *   const size_t price = reader.column_index("price");
+ *   reader.scan([&](size_t row) { sum += reader.int_value(price, row); });
+ **/
+class ColumnarReader {
+public:
+  explicit ColumnarReader(const std::string& path) : in_(path, std::ios::binary) {
+    CHECK(in_) << "can't open " << path;
+    char magic[sizeof(kColumnarMagic) - 1];
+    in_.read(magic, sizeof(magic));
+    CHECK(in_ && memcmp(magic, kColumnarMagic, sizeof(magic)) == 0) << path << " is not a columnar table";
+    CHECK(read_stream_varint() == kColumnarVersion) << "unsupported version of " << path;
+    const uint64_t columns_count = read_stream_varint();
+    for (uint64_t i = 0; i < columns_count; ++i) {
+      const auto type = static_cast<ColumnType>(in_.get());
+      std::string name(read_stream_varint(), '\0');
+      in_.read(&name[0], name.size());
+      columns_.emplace_back();
+      columns_.back().spec = ColumnSpec{std::move(name), type};
+    }
+    CHECK(in_) << path << " is truncated";
+  }
+
+  std::vector<ColumnSpec> columns() const {
+    std::vector<ColumnSpec> specs;
+    for (const Column& column : columns_) {
+      specs.push_back(column.spec);
+    }
+    return specs;
+  }
+
+  // Номер колонки @name.
+  size_t column_index(const std::string& name) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+      if (columns_[i].spec.name == name) {
+        return i;
+      }
+    }
+    FATAL() << "unknown column '" << name << "'";
+  }
+
+  // Оставляет строки, в которых значение числовой колонки @name лежит в [@min, @max].
+  // Границы могут быть любого арифметического типа и приводятся к типу колонки;
+  // для целой колонки дробные границы округляются внутрь отрезка.
+  template <typename Min, typename Max,
+            typename = std::enable_if_t<std::is_arithmetic<Min>::value && std::is_arithmetic<Max>::value>>
+  void where_between(const std::string& name, Min min, Max max) {
+    const size_t column = column_index(name);
+    switch (columns_[column].spec.type) {
+      case ColumnType::Int64:
+        predicates_.push_back(Predicate{column, int_bound(min, true), int_bound(max, false), 0, 0, {}, 0});
+        break;
+      case ColumnType::Double:
+        predicates_.push_back(Predicate{column, 0, 0, static_cast<double>(min), static_cast<double>(max), {}, 0});
+        break;
+      case ColumnType::String:
+        FATAL() << "column '" << name << "' is not numeric";
+    }
+  }
+
+  // Оставляет строки, в которых значение строковой колонки @name равно @value.
+  void where_equal(const std::string& name, const std::string& value) {
+    const size_t column = column_index(name);
+    CHECK(columns_[column].spec.type == ColumnType::String) << "column '" << name << "' is not String";
+    predicates_.push_back(Predicate{column, 0, 0, 0, 0, value, 0});
+  }
+
+  // Переходит к следующему блоку, в котором есть подходящие строки.
+  // Возвращает false, если блоки закончились.
+  bool next_block() {
+    while (read_block()) {
+      if (filter_block()) {
+        return true;
+      }
+      ++skipped_blocks_;
+    }
+    return false;
+  }
+
+  // Номера подходящих строк текущего блока.
+  const std::vector<uint32_t>& rows() const {
+    return rows_;
+  }
+
+  int64_t int_value(size_t column, size_t row) {
+    return decoded(column).ints[row];
+  }
+
+  double double_value(size_t column, size_t row) {
+    return decoded(column).doubles[row];
+  }
+
+  StringView string_value(size_t column, size_t row) {
+    Column& data = decoded(column);
+    return data.dictionary[data.codes[row]];
+  }
+
+  // Вызывает @callback(row) для каждой подходящей строки всех оставшихся блоков.
+  template <typename Callback>
+  void scan(Callback callback) {
+    while (next_block()) {
+      for (uint32_t row : rows_) {
+        callback(row);
+      }
+    }
+  }
+
+  // Количество блоков, пропущенных по условиям.
+  size_t skipped_blocks() const {
+    return skipped_blocks_;
+  }
+
+private:
+  struct Column {
+    ColumnSpec spec;
+    bool decoded = false;
+    const uint8_t* payload = nullptr;
+    const uint8_t* payload_end = nullptr;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<uint32_t> codes;
+    std::vector<StringView> dictionary;
+  };
+
+  struct Predicate {
+    size_t column;
+    int64_t int_min;
+    int64_t int_max;
+    double double_min;
+    double double_max;
+    std::string value;
+    // Номер значения @value в словаре текущего блока.
+    uint32_t code;
+  };
+
+  // Граница целого условия: @value, приведенное к диапазону int64_t
+  // (дробное значение округляется вверх для нижней границы, @lower, и вниз для верхней).
+  template <typename T>
+  static int64_t int_bound(T value, bool lower) {
+    return int_bound(value, lower, std::is_integral<T>());
+  }
+
+  template <typename T>
+  static int64_t int_bound(T value, bool, std::true_type) {
+    if (std::is_unsigned<T>::value && static_cast<uint64_t>(value) > static_cast<uint64_t>(kInt64Max)) {
+      return kInt64Max;
+    }
+    return static_cast<int64_t>(value);
+  }
+
+  template <typename T>
+  static int64_t int_bound(T value, bool lower, std::false_type) {
+    const double rounded = lower ? std::ceil(static_cast<double>(value)) : std::floor(static_cast<double>(value));
+    if (rounded <= -9.2233720368547758e18) {
+      return std::numeric_limits<int64_t>::min();
+    }
+    if (rounded >= 9.2233720368547758e18) {
+      return kInt64Max;
+    }
+    return static_cast<int64_t>(rounded);
+  }
+
+  static constexpr int64_t kInt64Max = std::numeric_limits<int64_t>::max();
+
+  uint64_t read_stream_varint() {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      const int byte = in_.get();
+      CHECK(byte != std::char_traits<char>::eof()) << "columnar table is truncated";
+      result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if (!(byte & 0x80)) {
+        break;
+      }
+    }
+    return result;
+  }
+
+  bool read_block() {
+    uint32_t block_size;
+    if (!in_.read(reinterpret_cast<char*>(&block_size), sizeof(block_size))) {
+      return false;
+    }
+    block_.resize(block_size);
+    in_.read(reinterpret_cast<char*>(block_.data()), block_size);
+    CHECK(in_) << "columnar table is truncated";
+    const uint8_t* in = block_.data();
+    const uint8_t* end = in + block_.size();
+    uint64_t rows_count;
+    in = impl::read_varint_or_fail(in, end, &rows_count);
+    rows_count_ = rows_count;
+    for (Column& column : columns_) {
+      uint64_t payload_size;
+      in = impl::read_varint_or_fail(in, end, &payload_size);
+      CHECK(payload_size <= static_cast<uint64_t>(end - in)) << "columnar table is corrupted";
+      column.payload = in;
+      column.payload_end = in + payload_size;
+      column.decoded = false;
+      in += payload_size;
+    }
+    return true;
+  }
+
+  // Отбирает строки блока по условиям. Возвращает false, если подходящих строк нет.
+  bool filter_block() {
+    for (Predicate& predicate : predicates_) {
+      if (!block_may_match(predicate)) {
+        return false;
+      }
+    }
+    rows_.resize(rows_count_);
+    for (uint32_t row = 0; row < rows_count_; ++row) {
+      rows_[row] = row;
+    }
+    for (const Predicate& predicate : predicates_) {
+      Column& column = decoded(predicate.column);
+      size_t kept = 0;
+      for (uint32_t row : rows_) {
+        if (row_matches(predicate, column, row)) {
+          rows_[kept++] = row;
+        }
+      }
+      rows_.resize(kept);
+    }
+    return !rows_.empty();
+  }
+
+  // Проверка блока по статистике, без декодирования значений.
+  bool block_may_match(Predicate& predicate) {
+    Column& column = columns_[predicate.column];
+    const uint8_t* in = column.payload;
+    switch (column.spec.type) {
+      case ColumnType::Int64: {
+        uint64_t min, max;
+        in = impl::read_varint_or_fail(in, column.payload_end, &min);
+        impl::read_varint_or_fail(in, column.payload_end, &max);
+        return zigzag_decode(min) <= predicate.int_max && zigzag_decode(max) >= predicate.int_min;
+      }
+      case ColumnType::Double: {
+        double min, max;
+        in = impl::read_raw(in, column.payload_end, &min);
+        impl::read_raw(in, column.payload_end, &max);
+        return min <= predicate.double_max && max >= predicate.double_min;
+      }
+      case ColumnType::String: {
+        // Просматривается только словарь блока; номера значений не декодируются.
+        uint64_t dictionary_size;
+        in = impl::read_varint_or_fail(in, column.payload_end, &dictionary_size);
+        for (uint64_t code = 0; code < dictionary_size; ++code) {
+          uint64_t length;
+          in = impl::read_varint_or_fail(in, column.payload_end, &length);
+          CHECK(length <= static_cast<uint64_t>(column.payload_end - in)) << "columnar table is corrupted";
+          if (length == predicate.value.size() && memcmp(in, predicate.value.data(), length) == 0) {
+            predicate.code = static_cast<uint32_t>(code);
+            return true;
+          }
+          in += length;
+        }
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool row_matches(const Predicate& predicate, const Column& column, uint32_t row) {
+    switch (column.spec.type) {
+      case ColumnType::Int64:
+        return column.ints[row] >= predicate.int_min && column.ints[row] <= predicate.int_max;
+      case ColumnType::Double:
+        return column.doubles[row] >= predicate.double_min && column.doubles[row] <= predicate.double_max;
+      case ColumnType::String:
+        return column.codes[row] == predicate.code;
+    }
+    return false;
+  }
+
+  Column& decoded(size_t index) {
+    Column& column = columns_[index];
+    if (!column.decoded) {
+      decode(column);
+      column.decoded = true;
+    }
+    return column;
+  }
+
+  void decode(Column& column) {
+    const uint8_t* in = column.payload;
+    const uint8_t* end = column.payload_end;
+    switch (column.spec.type) {
+      case ColumnType::Int64: {
+        uint64_t stat;
+        in = impl::read_varint_or_fail(in, end, &stat);
+        in = impl::read_varint_or_fail(in, end, &stat);
+        raw_.resize(rows_count_);
+        CHECK(read_varint_vector(in, end, raw_.data(), raw_.size())) << "columnar table is corrupted";
+        column.ints.resize(rows_count_);
+        uint64_t previous = 0;
+        for (size_t i = 0; i < raw_.size(); ++i) {
+          previous += static_cast<uint64_t>(zigzag_decode(raw_[i]));
+          column.ints[i] = static_cast<int64_t>(previous);
+        }
+        break;
+      }
+      case ColumnType::Double: {
+        in += 2 * sizeof(double);
+        CHECK(static_cast<size_t>(end - in) == rows_count_ * sizeof(double)) << "columnar table is corrupted";
+        column.doubles.resize(rows_count_);
+        memcpy(column.doubles.data(), in, rows_count_ * sizeof(double));
+        break;
+      }
+      case ColumnType::String: {
+        uint64_t dictionary_size;
+        in = impl::read_varint_or_fail(in, end, &dictionary_size);
+        column.dictionary.clear();
+        for (uint64_t i = 0; i < dictionary_size; ++i) {
+          uint64_t length;
+          in = impl::read_varint_or_fail(in, end, &length);
+          CHECK(length <= static_cast<uint64_t>(end - in)) << "columnar table is corrupted";
+          column.dictionary.emplace_back(reinterpret_cast<const char*>(in), length);
+          in += length;
+        }
+        column.codes.resize(rows_count_);
+        CHECK(read_varint_vector(in, end, column.codes.data(), column.codes.size())) <<
+            "columnar table is corrupted";
+        for (uint32_t code : column.codes) {
+          CHECK(code < dictionary_size) << "columnar table is corrupted";
+        }
+        break;
+      }
+    }
+  }
+
+  std::ifstream in_;
+  std::vector<Column> columns_;
+  std::vector<Predicate> predicates_;
+  std::vector<uint8_t> block_;
+  std::vector<uint64_t> raw_;
+  std::vector<uint32_t> rows_;
+  size_t rows_count_ = 0;
+  size_t skipped_blocks_ = 0;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "base/json.h"
+#include "base/string_stream.h"
+
+namespace hftbattle {
+
+/**
+ * ConfigBinder один раз переносит параметры из конфига стратегии в поля обычной структуры.
+ * Для каждого поля задаются ключ и, при необходимости, проверка; значением по умолчанию
+ * служит начальное значение поля структуры.
+ * За один проход bind:
+ * - заданные в конфиге ключи читаются и проверяются, ошибки (неверный тип, не прошла проверка,
+ *   нет обязательного ключа) собираются в список, а не обрываются на первой;
+ * - для отсутствующих ключей молча берется значение по умолчанию (без записи в лог на каждый ключ);
+ * - итоговые значения можно записать в лог одной строкой методом describe.
+ * Дальше стратегия читает параметры прямо из структуры, без обращений к JsonValue.
+ *
+ * Пример:
+ *   struct Params {
+ *     int32_t min_deals_count_diff = 100;
+ *     Milliseconds deals_reset_period = 10ms;
+ *   };
+ *
+ *   ConfigBinder<Params> binder;
+ *   binder.field("min_deals_count_diff", &Params::min_deals_count_diff,
+ *                [](int32_t value) { return value > 0; }, "must be positive")
+ *         .field("deals_reset_period_ms", &Params::deals_reset_period);
+ *   Params params;
+ *   CHECK(binder.bind(config, &params)) << binder.errors_string();
+ *   INFO() << binder.describe(params);
+ **/
+template <typename Config>
+class ConfigBinder {
+public:
+  // Связывает необязательный ключ @key с полем @member.
+  // Если ключа нет в конфиге, поле сохраняет свое значение.
+  template <typename T>
+  ConfigBinder& field(const std::string& key, T Config::* member) {
+    return add_field(key, member, false, std::function<bool(const T&)>(), std::string());
+  }
+
+  // То же, с проверкой @validator значения из конфига; @message попадает в текст ошибки.
+  template <typename T, typename Validator>
+  ConfigBinder& field(const std::string& key, T Config::* member,
+                      Validator validator, const std::string& message) {
+    return add_field(key, member, false, std::function<bool(const T&)>(validator), message);
+  }
+
+  // Связывает обязательный ключ @key с полем @member.
+  template <typename T>
+  ConfigBinder& required(const std::string& key, T Config::* member) {
+    return add_field(key, member, true, std::function<bool(const T&)>(), std::string());
+  }
+
+  // Заполняет @result значениями из @config.
+  // Возвращает true, если ошибок нет; иначе ошибки доступны через errors.
+  bool bind(const JsonValue& config, Config* result) {
+    errors_.clear();
+    for (const auto& field : fields_) {
+      field->bind(config, result, &errors_);
+    }
+    return errors_.empty();
+  }
+
+  const std::vector<std::string>& errors() const {
+    return errors_;
+  }
+
+  // Все ошибки последнего bind одной строкой.
+  std::string errors_string() const {
+    std::string result;
+    for (const std::string& error : errors_) {
+      result += result.empty() ? "" : "; ";
+      result += error;
+    }
+    return result;
+  }
+
+  // Значения всех связанных полей @config одной строкой: "key1: value1, key2: value2".
+  std::string describe(const Config& config) const {
+    StringStream stream;
+    for (size_t i = 0; i < fields_.size(); ++i) {
+      stream << (i ? ", " : "") << fields_[i]->key << ": ";
+      fields_[i]->describe(config, stream);
+    }
+    return stream.std_str();
+  }
+
+private:
+  struct FieldBase {
+    explicit FieldBase(const std::string& key) : key(key) {}
+    virtual ~FieldBase() = default;
+    virtual void bind(const JsonValue& config, Config* result, std::vector<std::string>* errors) const = 0;
+    virtual void describe(const Config& config, StringStream& stream) const = 0;
+
+    const std::string key;
+  };
+
+  template <typename T>
+  struct Field : FieldBase {
+    Field(const std::string& key, T Config::* member, bool required,
+          std::function<bool(const T&)> validator, const std::string& message)
+      : FieldBase(key), member(member), required(required), validator(std::move(validator)), message(message) {
+    }
+
+    void bind(const JsonValue& config, Config* result, std::vector<std::string>* errors) const override {
+      if (!config.is_member(this->key)) {
+        if (required) {
+          errors->push_back("'" + this->key + "' is required");
+        }
+        return;
+      }
+      T value;
+      try {
+        value = config[this->key].template as<T>();
+      } catch (const std::exception& e) {
+        errors->push_back("'" + this->key + "': " + e.what());
+        return;
+      }
+      if (validator && !validator(value)) {
+        errors->push_back("'" + this->key + "' " + message);
+        return;
+      }
+      result->*member = value;
+    }
+
+    void describe(const Config& config, StringStream& stream) const override {
+      stream << config.*member;
+    }
+
+    T Config::* const member;
+    const bool required;
+    const std::function<bool(const T&)> validator;
+    const std::string message;
+  };
+
+  template <typename T>
+  ConfigBinder& add_field(const std::string& key, T Config::* member, bool required,
+                          std::function<bool(const T&)> validator, const std::string& message) {
+    fields_.emplace_back(new Field<T>(key, member, required, std::move(validator), message));
+    return *this;
+  }
+
+  std::vector<std::unique_ptr<FieldBase>> fields_;
+  std::vector<std::string> errors_;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include "base/decimal.h"
+#include "base/string_view.h"
+
+namespace hftbattle {
+
+/**
+ * Разбор десятичной записи числа в Decimal без промежуточного double: целая и дробная
+ * части накапливаются сразу в числителе, поэтому цена, записанная StringStream,
+ * читается обратно точно. Формат: необязательный знак, цифры, необязательная точка
+ * и цифры дробной части ("12", "-0.25", "3.", ".5").
+ * Цифры дробной части сверх Decimal::kMultPow отбрасываются с округлением половины
+ * от нуля, как в конструкторе Decimal(double).
+ **/
+
+// Разбирает число в начале [@begin, @end) в @result.
+// Возвращает указатель за последним разобранным символом или nullptr, если числа нет
+// или оно не помещается в Decimal.
+inline const char* parse_decimal(const char* begin, const char* end, Decimal* result) {
+  const char* itr = begin;
+  bool negative = false;
+  if (itr != end && (*itr == '-' || *itr == '+')) {
+    negative = *itr == '-';
+    ++itr;
+  }
+  const uint64_t kMaxIntegral = static_cast<uint64_t>(std::numeric_limits<int64_t>::max() / Decimal::kMultFactor);
+  uint64_t integral = 0;
+  int32_t digits = 0;
+  for (; itr != end && *itr >= '0' && *itr <= '9'; ++itr, ++digits) {
+    integral = integral * 10 + static_cast<uint64_t>(*itr - '0');
+    if (integral > kMaxIntegral) {
+      return nullptr;
+    }
+  }
+  uint64_t fractional = 0;
+  int32_t fractional_digits = 0;
+  bool round_up = false;
+  if (itr != end && *itr == '.') {
+    for (++itr; itr != end && *itr >= '0' && *itr <= '9'; ++itr, ++digits) {
+      if (fractional_digits < Decimal::kMultPow) {
+        fractional = fractional * 10 + static_cast<uint64_t>(*itr - '0');
+        ++fractional_digits;
+      } else if (fractional_digits == Decimal::kMultPow) {
+        round_up = *itr >= '5';
+        ++fractional_digits;
+      }
+    }
+  }
+  if (digits == 0) {
+    return nullptr;
+  }
+  for (int32_t i = fractional_digits; i < Decimal::kMultPow; ++i) {
+    fractional *= 10;
+  }
+  const uint64_t numerator = integral * static_cast<uint64_t>(Decimal::kMultFactor) + fractional + (round_up ? 1 : 0);
+  if (numerator > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+    return nullptr;
+  }
+  const int64_t signed_numerator = static_cast<int64_t>(numerator);
+  *result = Decimal::from_numerator(negative ? -signed_numerator : signed_numerator);
+  return itr;
+}
+
+// Разбирает строку @text, которая целиком должна быть записью числа.
+// Возвращает false, если это не так.
+inline bool parse_decimal(StringView text, Decimal* result) {
+  const char* end = text.data() + text.length();
+  const char* parsed = parse_decimal(text.data(), end, result);
+  return parsed != nullptr && parsed == end;
+}
+
+}  // namespace hftbattle
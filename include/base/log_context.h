@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include "base/log.h"
+
+namespace hftbattle {
+
+/**
+ * Контексты логирования для нескольких симуляций в одном процессе.
+ *
+ * Общий логгер (getCurrentLoggerId) и бэкенд по умолчанию (GetDefaultBackend) одни
+ * на процесс: если несколько симуляций работают в разных потоках, их сообщения
+ * перемешиваются в одном выводе. LogContext - отдельный логгер со своим уровнем
+ * и своим файлом. Сообщения копятся в буфере контекста и пишутся в файл большими
+ * блоками, без блокировок: контекст в каждый момент используется одним потоком.
+ *
+ * Текущий контекст потока задается ScopedLogContext и хранится в thread_local,
+ * поэтому переключение контекста - запись одного указателя. Макросы CONTEXT_INFO() и
+ * другие пишут в текущий контекст потока, а без него - в общий логгер, как INFO().
+ **/
+
+// Бэкенд, который копит сообщения в буфере и пишет их в файл, когда буфер заполнен,
+// при flush и при разрушении. Не потокобезопасен.
+class BufferedFileBackend : public Backend {
+public:
+  explicit BufferedFileBackend(const std::string& filename, size_t buffer_size = 1 << 16)
+    : file_(fopen(filename.c_str(), "w")), buffer_size_(buffer_size) {
+    CHECK(file_) << "can't open " << filename;
+    buffer_.reserve(buffer_size_ + 1024);
+  }
+
+  ~BufferedFileBackend() {
+    flush();
+    fclose(file_);
+  }
+
+  // Источник времени для префикса сообщений (например, серверное время симуляции).
+  // Без него время в префиксе не пишется.
+  void set_clock(std::function<Microseconds()> clock) {
+    clock_ = std::move(clock);
+  }
+
+  void log(LogMessage* message) override {
+    if (clock_) {
+      put_time(clock_());
+      buffer_ << ' ';
+    }
+    buffer_ << level_name(message->level()) << '[' << message->logger()->name() << "]: "
+            << message->text() << '\n';
+    if (buffer_.size() >= buffer_size_) {
+      flush();
+    }
+  }
+
+  void flush() override {
+    const StringView text = buffer_.view();
+    if (!text.empty()) {
+      fwrite(text.data(), 1, text.length(), file_);
+      buffer_.clear();
+    }
+    fflush(file_);
+  }
+
+private:
+  static const char* level_name(LogLevel level) {
+    switch (level) {
+      case LogLevel::Debug: return "DEBUG";
+      case LogLevel::Info: return "INFO";
+      case LogLevel::Warning: return "WARNING";
+      case LogLevel::Error: return "ERROR";
+      case LogLevel::Fatal: return "FATAL";
+    }
+    return "";
+  }
+
+  // Время суток в формате HH:MM:SS.ffffff.
+  void put_time(Microseconds time) {
+    const int64_t us = time.count();
+    const int64_t seconds = us / 1000000;
+    buffer_.put_integral(seconds / 3600 % 24, 2);
+    buffer_ << ':';
+    buffer_.put_integral(seconds / 60 % 60, 2);
+    buffer_ << ':';
+    buffer_.put_integral(seconds % 60, 2);
+    buffer_ << '.';
+    buffer_.put_integral(us % 1000000, 6);
+  }
+
+  FILE* file_;
+  size_t buffer_size_;
+  StringStream buffer_;
+  std::function<Microseconds()> clock_;
+};
+
+// Логгер симуляции с собственным файлом.
+class LogContext {
+public:
+  LogContext(const std::string& name, const std::string& filename)
+    : backend_(std::make_shared<BufferedFileBackend>(filename)),
+      logger_(new Logger(name, std::make_shared<BackendHolder>(backend_))) {
+    logger_->set_min_level(Logger::default_min_level());
+  }
+
+  LogContext(const LogContext&) = delete;
+  LogContext& operator=(const LogContext&) = delete;
+
+  ~LogContext() {
+    backend_->flush();
+  }
+
+  LoggerId logger() const {
+    return logger_.get();
+  }
+
+  BufferedFileBackend& backend() {
+    return *backend_;
+  }
+
+  void set_min_level(LogLevel min_level) {
+    logger_->set_min_level(min_level);
+  }
+
+  void flush() {
+    backend_->flush();
+  }
+
+  // Текущий контекст потока или nullptr.
+  static LogContext* current() {
+    return current_ref();
+  }
+
+private:
+  friend class ScopedLogContext;
+
+  static LogContext*& current_ref() {
+    static thread_local LogContext* current = nullptr;
+    return current;
+  }
+
+  std::shared_ptr<BufferedFileBackend> backend_;
+  std::unique_ptr<Logger> logger_;
+};
+
+// Делает @context текущим контекстом потока на время своей жизни.
+class ScopedLogContext {
+public:
+  explicit ScopedLogContext(LogContext* context) : previous_(LogContext::current_ref()) {
+    LogContext::current_ref() = context;
+  }
+
+  ScopedLogContext(const ScopedLogContext&) = delete;
+  ScopedLogContext& operator=(const ScopedLogContext&) = delete;
+
+  ~ScopedLogContext() {
+    LogContext::current_ref() = previous_;
+  }
+
+private:
+  LogContext* previous_;
+};
+
+// Логгер текущего контекста потока, а без контекста - общий логгер.
+inline LoggerId getContextLoggerId() {
+  LogContext* context = LogContext::current();
+  return context ? context->logger() : getCurrentLoggerId();
+}
+
+#define CONTEXT_DEBUG() PRIVATE_LOG(getContextLoggerId(), LogLevel::Debug)
+#define CONTEXT_INFO() PRIVATE_LOG(getContextLoggerId(), LogLevel::Info)
+#define CONTEXT_WARNING() PRIVATE_LOG(getContextLoggerId(), LogLevel::Warning)
+#define CONTEXT_ERROR() PRIVATE_LOG(getContextLoggerId(), LogLevel::Error)
+
+#define CONTEXT_DEBUG_IF(condition) PRIVATE_LOG_IF(getContextLoggerId(), LogLevel::Debug, condition)
+#define CONTEXT_INFO_IF(condition) PRIVATE_LOG_IF(getContextLoggerId(), LogLevel::Info, condition)
+#define CONTEXT_WARNING_IF(condition) PRIVATE_LOG_IF(getContextLoggerId(), LogLevel::Warning, condition)
+#define CONTEXT_ERROR_IF(condition) PRIVATE_LOG_IF(getContextLoggerId(), LogLevel::Error, condition)
+
+}  // namespace hftbattle
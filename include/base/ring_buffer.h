@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace hftbattle {
+
+/**
+ * RingBuffer - очередь на кольцевом буфере. Добавление в конец и удаление из начала
+ * стоят O(1) (добавление - амортизированно: при заполнении емкость удваивается),
+ * память после разгона очереди больше не выделяется. Емкость всегда степень двойки,
+ * поэтому индекс в буфере вычисляется маской.
+ **/
+template <typename T>
+class RingBuffer {
+public:
+  explicit RingBuffer(size_t capacity = 16) {
+    size_t rounded = 1;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    buffer_.resize(rounded);
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  void push_back(T value) {
+    if (size_ == buffer_.size()) {
+      grow();
+    }
+    buffer_[(head_ + size_) & (buffer_.size() - 1)] = std::move(value);
+    ++size_;
+  }
+
+  void pop_front() {
+    head_ = (head_ + 1) & (buffer_.size() - 1);
+    --size_;
+  }
+
+  // Удаляет @count элементов из начала.
+  void pop_front(size_t count) {
+    head_ = (head_ + count) & (buffer_.size() - 1);
+    size_ -= count;
+  }
+
+  T& front() {
+    return buffer_[head_];
+  }
+
+  const T& front() const {
+    return buffer_[head_];
+  }
+
+  T& back() {
+    return (*this)[size_ - 1];
+  }
+
+  const T& back() const {
+    return (*this)[size_ - 1];
+  }
+
+  // Элемент с номером @index от начала очереди.
+  T& operator[](size_t index) {
+    return buffer_[(head_ + index) & (buffer_.size() - 1)];
+  }
+
+  const T& operator[](size_t index) const {
+    return buffer_[(head_ + index) & (buffer_.size() - 1)];
+  }
+
+  void clear() {
+    head_ = 0;
+    size_ = 0;
+  }
+
+private:
+  void grow() {
+    std::vector<T> buffer(buffer_.size() * 2);
+    for (size_t i = 0; i < size_; ++i) {
+      buffer[i] = std::move((*this)[i]);
+    }
+    buffer_.swap(buffer);
+    head_ = 0;
+  }
+
+  std::vector<T> buffer_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,231 @@
+#pragma once
+
+#if !defined(_WIN32)
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "base/log.h"
+
+namespace hftbattle {
+
+/**
+ * SharedSegment - неизменяемые данные в именованной разделяемой памяти POSIX.
+ * Первый процесс, открывший сегмент, заполняет его (например, результатом долгой
+ * подготовки данных), остальные процессы подключаются к уже заполненному сегменту
+ * только для чтения и не тратят на эти данные ни память, ни время.
+ *
+ * Сегмент снабжен версией: процесс с другой версией (например, другой датой или другим
+ * форматом данных) сегмент не использует. Данные в сегменте должны быть тривиально
+ * копируемыми и не содержать указателей: адрес отображения в разных процессах разный.
+ * Сегмент живет до удаления методом remove (или до перезагрузки машины).
+ *
+ * Пока создатель заполняет сегмент, он держит на нем блокировку flock; ядро снимает ее
+ * и при аварийном завершении процесса. Если заполнение завершилось исключением, создатель
+ * удаляет сегмент; если создатель завершился, не заполнив сегмент, его удаляет первый
+ * заметивший это процесс. В обоих случаях ожидающие процессы создают сегмент заново.
+ **/
+class SharedSegment {
+public:
+  using Filler = std::function<void(void* data, size_t size)>;
+
+  // Подключается к сегменту @name версии @version размера @size или, если его еще нет,
+  // создает его и заполняет функцией @fill. Возвращает nullptr, если сегмент существует,
+  // но его версия или размер не совпадают.
+  static std::unique_ptr<SharedSegment> open_or_create(const std::string& name, uint64_t version,
+                                                       size_t size, const Filler& fill) {
+    const std::string shm_name = "/" + name;
+    while (true) {
+      const int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+      if (fd >= 0) {
+        return create(shm_name, fd, version, size, fill);
+      }
+      CHECK(errno == EEXIST) << "shm_open " << shm_name << " failed: " << strerror(errno);
+      std::unique_ptr<SharedSegment> segment;
+      if (attach(shm_name, version, size, &segment)) {
+        return segment;
+      }
+    }
+  }
+
+  // Удаляет сегмент @name. Уже подключенные процессы продолжают с ним работать.
+  static void remove(const std::string& name) {
+    shm_unlink(("/" + name).c_str());
+  }
+
+  SharedSegment(const SharedSegment&) = delete;
+  SharedSegment& operator=(const SharedSegment&) = delete;
+
+  ~SharedSegment() {
+    munmap(mapping_, mapping_size_);
+  }
+
+  const void* data() const {
+    return static_cast<const uint8_t*>(mapping_) + sizeof(Header);
+  }
+
+  size_t size() const {
+    return mapping_size_ - sizeof(Header);
+  }
+
+  // Создан ли сегмент этим процессом.
+  bool created() const {
+    return created_;
+  }
+
+private:
+  static constexpr uint64_t kMagic = 0x48424553484d3031ULL;  // "HBESHM01"
+
+  struct Header {
+    uint64_t magic;
+    uint64_t version;
+    uint64_t size;
+    std::atomic<uint32_t> ready;
+  };
+
+  SharedSegment(void* mapping, size_t mapping_size, bool created)
+    : mapping_(mapping), mapping_size_(mapping_size), created_(created) {
+  }
+
+  struct FileCloser {
+    int fd;
+
+    ~FileCloser() {
+      close(fd);
+    }
+  };
+
+  // Удаляет недозаполненный сегмент, если создание прервано исключением.
+  struct CreateGuard {
+    const std::string& shm_name;
+    int fd;
+    void* mapping;
+    size_t mapping_size;
+    bool armed;
+
+    ~CreateGuard() {
+      if (!armed) {
+        return;
+      }
+      // Имя удаляется до снятия блокировки, чтобы ожидающие процессы не удалили уже новый сегмент.
+      shm_unlink(shm_name.c_str());
+      if (mapping != MAP_FAILED) {
+        munmap(mapping, mapping_size);
+      }
+      close(fd);
+    }
+  };
+
+  static std::unique_ptr<SharedSegment> create(const std::string& shm_name, int fd, uint64_t version,
+                                               size_t size, const Filler& fill) {
+    const size_t mapping_size = sizeof(Header) + size;
+    CreateGuard guard{shm_name, fd, MAP_FAILED, mapping_size, true};
+    // Блокировка берется до задания размера: процесс, увидевший ненулевой размер без блокировки,
+    // знает, что создатель завершился.
+    CHECK(flock(fd, LOCK_EX) == 0) << "flock failed: " << strerror(errno);
+    CHECK(ftruncate(fd, static_cast<off_t>(mapping_size)) == 0) << "ftruncate failed: " << strerror(errno);
+    guard.mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    CHECK(guard.mapping != MAP_FAILED) << "mmap failed: " << strerror(errno);
+    void* mapping = guard.mapping;
+    Header* header = new (mapping) Header();
+    header->magic = kMagic;
+    header->version = version;
+    header->size = size;
+    fill(static_cast<uint8_t*>(mapping) + sizeof(Header), size);
+    header->ready.store(1, std::memory_order_release);
+    guard.armed = false;
+    // Отображение держит файл открытым, поэтому блокировку нужно снять явно.
+    flock(fd, LOCK_UN);
+    close(fd);
+    mprotect(mapping, mapping_size, PROT_READ);
+    return std::unique_ptr<SharedSegment>(new SharedSegment(mapping, mapping_size, true));
+  }
+
+  // Подключается к сегменту, дождавшись, пока создатель его заполнит, и записывает его в @result.
+  // Возвращает false, если сегмента уже нет или создатель завершился, не заполнив его:
+  // такой сегмент удаляется, и его нужно создать заново.
+  static bool attach(const std::string& shm_name, uint64_t version, size_t size,
+                     std::unique_ptr<SharedSegment>* result) {
+    const int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      CHECK(errno == ENOENT) << "shm_open " << shm_name << " failed: " << strerror(errno);
+      return false;
+    }
+    const FileCloser closer{fd};
+    // Сколько ждать, пока другой процесс заполнит сегмент.
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::minutes(10);
+    // Сколько ждать, пока создатель возьмет блокировку после shm_open.
+    const auto lock_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    std::unique_ptr<SharedSegment> segment;
+    while (true) {
+      // Создатель мог еще не задать размер сегмента.
+      struct stat info;
+      CHECK(fstat(fd, &info) == 0) << "fstat failed: " << strerror(errno);
+      const size_t mapping_size = static_cast<size_t>(info.st_size);
+      if (!segment && mapping_size >= sizeof(Header)) {
+        void* mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_SHARED, fd, 0);
+        CHECK(mapping != MAP_FAILED) << "mmap failed: " << strerror(errno);
+        segment.reset(new SharedSegment(mapping, mapping_size, false));
+      }
+      if (segment && segment->header()->ready.load(std::memory_order_acquire) != 0) {
+        break;
+      }
+      // Блокировка свободна, а сегмент не заполнен: создатель завершился, если он уже задал
+      // размер или так и не взял блокировку после shm_open.
+      if (flock(fd, LOCK_SH | LOCK_NB) == 0) {
+        flock(fd, LOCK_UN);
+        const bool ready = segment && segment->header()->ready.load(std::memory_order_acquire) != 0;
+        if (!ready && (segment || std::chrono::steady_clock::now() >= lock_deadline)) {
+          remove_if_same(shm_name, info);
+          return false;
+        }
+      }
+      CHECK(std::chrono::steady_clock::now() < deadline) << "timeout waiting for " << shm_name;
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    const Header* header = segment->header();
+    if (header->magic != kMagic || header->version != version || header->size != size ||
+        segment->mapping_size_ != sizeof(Header) + size) {
+      return true;
+    }
+    *result = std::move(segment);
+    return true;
+  }
+
+  // Удаляет сегмент @shm_name, если имя все еще указывает на файл @info,
+  // а не на сегмент, созданный заново другим процессом.
+  static void remove_if_same(const std::string& shm_name, const struct stat& info) {
+    const int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return;
+    }
+    const FileCloser closer{fd};
+    struct stat current;
+    if (fstat(fd, &current) == 0 && current.st_dev == info.st_dev && current.st_ino == info.st_ino) {
+      shm_unlink(shm_name.c_str());
+    }
+  }
+
+  const Header* header() const {
+    return static_cast<const Header*>(mapping_);
+  }
+
+  void* mapping_;
+  size_t mapping_size_;
+  bool created_;
+};
+
+}  // namespace hftbattle
+
+#endif  // !defined(_WIN32)
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace hftbattle {
+
+/**
+ * SpscQueue - ограниченная очередь без блокировок для одного писателя и одного читателя
+ * (single producer, single consumer). try_push вызывается только из потока писателя,
+ * try_pop - только из потока читателя.
+ *
+ * Индексы писателя и читателя лежат в разных кеш-линиях, и каждая сторона помнит
+ * последний увиденный индекс другой стороны, поэтому в обычном случае операция
+ * не читает кеш-линию другого потока. Емкость округляется вверх до степени двойки.
+ **/
+template <typename T>
+class SpscQueue {
+public:
+  explicit SpscQueue(size_t capacity = 1 << 16) {
+    size_t rounded = 2;
+    while (rounded < capacity) {
+      rounded <<= 1;
+    }
+    buffer_.resize(rounded);
+    mask_ = rounded - 1;
+  }
+
+  SpscQueue(const SpscQueue&) = delete;
+  SpscQueue& operator=(const SpscQueue&) = delete;
+
+  size_t capacity() const {
+    return buffer_.size();
+  }
+
+  // Добавляет @value в очередь. Возвращает false, если очередь заполнена.
+  bool try_push(T value) {
+    const size_t tail = producer_.position.load(std::memory_order_relaxed);
+    if (tail - producer_.cached_other == buffer_.size()) {
+      producer_.cached_other = consumer_.position.load(std::memory_order_acquire);
+      if (tail - producer_.cached_other == buffer_.size()) {
+        return false;
+      }
+    }
+    buffer_[tail & mask_] = std::move(value);
+    producer_.position.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Извлекает первый элемент очереди в @value. Возвращает false, если очередь пуста.
+  bool try_pop(T* value) {
+    const size_t head = consumer_.position.load(std::memory_order_relaxed);
+    if (head == consumer_.cached_other) {
+      consumer_.cached_other = producer_.position.load(std::memory_order_acquire);
+      if (head == consumer_.cached_other) {
+        return false;
+      }
+    }
+    *value = std::move(buffer_[head & mask_]);
+    consumer_.position.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Приблизительный размер: точен только в потоке, который сейчас не работает с очередью.
+  size_t size_approx() const {
+    return producer_.position.load(std::memory_order_acquire) - consumer_.position.load(std::memory_order_acquire);
+  }
+
+private:
+  static const size_t kCacheLineSize = 64;
+
+  struct alignas(kCacheLineSize) Side {
+    // Количество записанных (для писателя) или прочитанных (для читателя) элементов.
+    std::atomic<size_t> position{0};
+    // Последнее увиденное значение position другой стороны.
+    size_t cached_other = 0;
+  };
+
+  std::vector<T> buffer_;
+  size_t mask_;
+  Side producer_;
+  Side consumer_;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <utility>
+
+namespace hftbattle {
+
+// Ключ упорядочивания событий: сначала локальное время (tsc), затем биржевое (moment).
+struct EventOrderKey {
+  int64_t tsc;
+  int64_t moment;
+};
+
+inline bool operator<(const EventOrderKey& lhs, const EventOrderKey& rhs) {
+  return lhs.tsc < rhs.tsc || (lhs.tsc == rhs.tsc && lhs.moment < rhs.moment);
+}
+
+/**
+ * StreamMerger сливает несколько упорядоченных потоков событий в один (k-way merge)
+ * с помощью двоичной кучи: выбор следующего события стоит O(log k) для k потоков.
+ * При равных ключах первым идет поток, добавленный раньше, поэтому порядок слияния
+ * детерминирован (например, торговый инструмент всегда раньше сигнальных).
+ *
+ * Поток должен предоставлять методы:
+ *   bool empty() const;
+ *   EventOrderKey front_key() const;  // ключ ближайшего события
+ *   void pop();                       // переход к следующему событию
+ **/
+template <typename Stream>
+class StreamMerger {
+public:
+  // Добавляет поток @stream. Возвращает его номер.
+  size_t add_stream(Stream* stream) {
+    streams_.push_back(stream);
+    const size_t index = streams_.size() - 1;
+    if (!stream->empty()) {
+      heap_.push_back(index);
+      sift_up(heap_.size() - 1);
+    }
+    return index;
+  }
+
+  // Закончились ли события во всех потоках.
+  bool empty() const {
+    return heap_.empty();
+  }
+
+  // Номер потока, которому принадлежит ближайшее событие.
+  size_t top_index() const {
+    return heap_.front();
+  }
+
+  // Поток, которому принадлежит ближайшее событие.
+  Stream* top() const {
+    return streams_[heap_.front()];
+  }
+
+  // Извлекает ближайшее событие из его потока и восстанавливает кучу.
+  void pop() {
+    Stream* stream = top();
+    stream->pop();
+    if (stream->empty()) {
+      heap_.front() = heap_.back();
+      heap_.pop_back();
+    }
+    if (!heap_.empty()) {
+      sift_down(0);
+    }
+  }
+
+  // Сообщает, что поток @index после опустошения снова содержит события.
+  void reactivate(size_t index) {
+    heap_.push_back(index);
+    sift_up(heap_.size() - 1);
+  }
+
+  size_t streams_count() const {
+    return streams_.size();
+  }
+
+private:
+  bool less(size_t lhs, size_t rhs) const {
+    const EventOrderKey lhs_key = streams_[lhs]->front_key();
+    const EventOrderKey rhs_key = streams_[rhs]->front_key();
+    if (lhs_key < rhs_key) {
+      return true;
+    }
+    if (rhs_key < lhs_key) {
+      return false;
+    }
+    return lhs < rhs;
+  }
+
+  void sift_up(size_t pos) {
+    while (pos > 0) {
+      const size_t parent = (pos - 1) / 2;
+      if (!less(heap_[pos], heap_[parent])) {
+        break;
+      }
+      std::swap(heap_[pos], heap_[parent]);
+      pos = parent;
+    }
+  }
+
+  void sift_down(size_t pos) {
+    const size_t size = heap_.size();
+    while (true) {
+      const size_t left = 2 * pos + 1;
+      if (left >= size) {
+        break;
+      }
+      const size_t right = left + 1;
+      const size_t child = (right < size && less(heap_[right], heap_[left])) ? right : left;
+      if (!less(heap_[child], heap_[pos])) {
+        break;
+      }
+      std::swap(heap_[pos], heap_[child]);
+      pos = child;
+    }
+  }
+
+  std::vector<Stream*> streams_;
+  std::vector<size_t> heap_;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include "base/string_view.h"
+
+namespace hftbattle {
+
+using StringId = uint32_t;
+
+/**
+ * StringInterner хранит каждую строку (комментарий, символ инструмента) в одном экземпляре
+ * и выдает ей целочисленный идентификатор. Дальше строку можно передавать и сравнивать
+ * по идентификатору, а читать через StringView без копирования.
+ * Строки не перемещаются, поэтому ссылки и StringView на них остаются действительными
+ * до вызова clear (или до разрушения интернера).
+ * Пустой строке всегда соответствует идентификатор kEmptyStringId.
+ **/
+class StringInterner {
+public:
+  static constexpr StringId kEmptyStringId = 0;
+
+  StringInterner() {
+    intern(StringView());
+  }
+
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  // Идентификатор строки @str; при первом обращении строка сохраняется.
+  StringId intern(StringView str) {
+    auto it = ids_.find(str);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    const StringId id = static_cast<StringId>(strings_.size());
+    strings_.emplace_back(str.data() ? std::string(str.data(), str.length()) : std::string());
+    ids_.emplace(StringView(strings_.back()), id);
+    return id;
+  }
+
+  StringId intern(const std::string& str) {
+    return intern(StringView(str));
+  }
+
+  // Строка с идентификатором @id.
+  const std::string& str(StringId id) const {
+    return strings_[id];
+  }
+
+  StringView view(StringId id) const {
+    return StringView(strings_[id]);
+  }
+
+  size_t size() const {
+    return strings_.size();
+  }
+
+  // Удаляет все строки, кроме пустой. Выданные ранее идентификаторы и ссылки
+  // на строки становятся недействительными.
+  void clear() {
+    ids_.clear();
+    strings_.clear();
+    intern(StringView());
+  }
+
+private:
+  struct Hash {
+    size_t operator()(StringView str) const {
+      // FNV-1a
+      uint64_t hash = 14695981039346656037ULL;
+      for (char c : str) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ULL;
+      }
+      return static_cast<size_t>(hash);
+    }
+  };
+
+  struct Equal {
+    bool operator()(StringView lhs, StringView rhs) const {
+      return lhs.length() == rhs.length() &&
+             (lhs.length() == 0 || memcmp(lhs.data(), rhs.data(), lhs.length()) == 0);
+    }
+  };
+
+  std::deque<std::string> strings_;
+  std::unordered_map<StringView, StringId, Hash, Equal> ids_;
+};
+
+}  // namespace hftbattle
@@ -219,7 +219,18 @@ class StringStreamBase {
         x = -x;
       }
       T power = static_cast<T>(precision_power_);
-      x = static_cast<T>(std::round(x * power) / power);
+      const T rounded = std::round(x * power);
+      // Пока округленное значение меньше 2^50, деление double на 10^precision и обратное
+      // умножение дробной части не теряют точности, поэтому целая и дробная части
+      // совпадают с частным и остатком целочисленного деления - считаем их так.
+      if (std::is_same<T, double>::value && rounded < kExactDoubleLimit) {
+        const uint64_t value = static_cast<uint64_t>(rounded);
+        const uint64_t integral = divide_by_pow10(value, precision_);
+        const uint64_t fractional = value - integral * static_cast<uint64_t>(precision_power_);
+        put_decimal(static_cast<int64_t>(integral), static_cast<int64_t>(fractional), fill_zeroes);
+        return;
+      }
+      x = static_cast<T>(rounded / power);
       auto integral = std::llround(std::trunc(x));
       auto fractional = std::llround((x - std::trunc(x)) * power);
       put_decimal(integral, fractional, fill_zeroes);
@@ -236,7 +247,8 @@ class StringStreamBase {
       if (precision_ >= Decimal::kMultPow) {
         fractional *= stored_pow10(static_cast<size_t>(precision_ - Decimal::kMultPow));
       } else {
-        fractional = divide_and_round(fractional, stored_pow10(static_cast<size_t>(Decimal::kMultPow - precision_)));
+        const int8_t shift = static_cast<int8_t>(Decimal::kMultPow - precision_);
+        fractional = divide_by_pow10(fractional + stored_pow10(static_cast<size_t>(shift)) / 2, shift);
         if (fractional >= precision_power_) {
           fractional -= precision_power_;
           ++integral;
@@ -246,6 +258,29 @@ class StringStreamBase {
     }
 
   private:
+    static constexpr double kExactDoubleLimit = 1125899906842624.0;  // 2^50
+    // Максимальное количество цифр 64-битного числа.
+    static constexpr int32_t kMaxDigits = 20;
+
+    // Деление на 10^@power. Для степеней до 9 делитель - константа,
+    // и компилятор заменяет деление умножением.
+    template <typename T>
+    static T divide_by_pow10(T value, int8_t power) {
+      switch (power) {
+        case 0: return value;
+        case 1: return value / 10;
+        case 2: return value / 100;
+        case 3: return value / 1000;
+        case 4: return value / 10000;
+        case 5: return value / 100000;
+        case 6: return value / 1000000;
+        case 7: return value / 10000000;
+        case 8: return value / 100000000;
+        case 9: return value / 1000000000;
+        default: return power < 0 ? value : value / static_cast<T>(stored_pow10(static_cast<size_t>(power)));
+      }
+    }
+
     void init() {
       precision_ = 6;
       precision_power_ = 1000000;
@@ -307,11 +342,56 @@ class StringStreamBase {
       }
 
     void put_decimal(int64_t integral, int64_t fractional, int32_t fill_zeroes = 0) {
-      put_integral(integral, fill_zeroes);
-      if (fractional != 0 || fill_zeroes_after_point_) {
-        buffer_.push_back('.');
-        put_integral_impl(fractional, precision_, !fill_zeroes_after_point_);
+      const bool put_fractional = fractional != 0 || fill_zeroes_after_point_;
+      if (integral < 0 || fractional < 0 || precision_ < 0 || fill_zeroes > kMaxDigits) {
+        put_integral(integral, fill_zeroes);
+        if (put_fractional) {
+          buffer_.push_back('.');
+          put_integral_impl(fractional, precision_, !fill_zeroes_after_point_);
+        }
+        return;
+      }
+      // Обе части числа собираются в локальном буфере и добавляются одной вставкой.
+      char buffer[2 * kMaxDigits + 1];
+      char* end = buffer + sizeof(buffer);
+      char* begin = end;
+      if (put_fractional) {
+        uint64_t digits = static_cast<uint64_t>(fractional);
+        // Как и put_integral_impl, дробная часть пишется хотя бы одной цифрой ("123.0" при Precision(0)).
+        int32_t width = std::max<int32_t>(precision_, 1);
+        if (!fill_zeroes_after_point_) {
+          while (digits % 10 == 0) {
+            digits /= 10;
+            --width;
+          }
+        }
+        begin = write_digits_backward(digits, width, begin);
+        *(--begin) = '.';
+      }
+      begin = write_digits_backward(static_cast<uint64_t>(integral), std::max(fill_zeroes, 1), begin);
+      put_chars(begin, static_cast<size_t>(end - begin));
+    }
+
+    // Записывает число @x не меньше чем @min_width цифрами (с ведущими нулями), заканчивая
+    // перед @end. Возвращает указатель на первую цифру.
+    static char* write_digits_backward(uint64_t x, int32_t min_width, char* end) {
+      char* itr = end;
+      while (x >= 100) {
+        const uint64_t next = x / 100;
+        itr -= 2;
+        memcpy(itr, &DigitTables::rev_2digit_lut[2 * (x - next * 100)], 2);
+        x = next;
+      }
+      if (x >= 10) {
+        itr -= 2;
+        memcpy(itr, &DigitTables::rev_2digit_lut[2 * x], 2);
+      } else if (x > 0) {
+        *(--itr) = static_cast<char>('0' + x);
+      }
+      while (end - itr < min_width) {
+        *(--itr) = '0';
       }
+      return itr;
     }
 
     template <typename T>
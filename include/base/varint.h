@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace hftbattle {
+
+/**
+ * Кодирование целых чисел в формате varint (LEB128): по 7 бит на байт начиная с младших,
+ * старший бит байта означает, что число продолжается в следующем байте.
+ *
+ * Декодирование проверяет границы буфера только вблизи его конца: пока до конца
+ * остается не меньше kMaxVarintSize байт, число читается без проверок.
+ * При декодировании массива 8 подряд идущих однобайтовых чисел (типичный случай для
+ * приращений цен и объемов) распознаются одной проверкой 8-байтового слова.
+ **/
+
+// Максимальный размер 64-битного числа в формате varint.
+constexpr size_t kMaxVarintSize = 10;
+
+namespace impl {
+
+constexpr uint64_t kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Побайтовое декодирование с проверкой границ.
+inline const uint8_t* read_varint_checked(const uint8_t* in, const uint8_t* end, uint64_t* value) {
+  uint64_t result = 0;
+  for (int shift = 0; shift < 64 && in < end; shift += 7) {
+    const uint8_t byte = *in++;
+    result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      *value = result;
+      return in;
+    }
+  }
+  return nullptr;
+}
+
+// Декодирование без проверки границ: до конца буфера должно оставаться не меньше kMaxVarintSize байт.
+inline const uint8_t* read_varint_unchecked(const uint8_t* in, uint64_t* value) {
+  uint64_t byte = *in++;
+  uint64_t result = byte & 0x7F;
+  for (int shift = 7; (byte & 0x80) && shift < 64; shift += 7) {
+    byte = *in++;
+    result |= (byte & 0x7F) << shift;
+  }
+  if (byte & 0x80) {
+    return nullptr;
+  }
+  *value = result;
+  return in;
+}
+
+inline uint64_t load_word(const uint8_t* in) {
+  uint64_t word;
+  memcpy(&word, in, sizeof(word));
+  return word;
+}
+
+}  // namespace impl
+
+// Количество байт, которое займет число @value.
+inline size_t varint_size(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+// Записывает число @value в @out. Возвращает указатель за последним записанным байтом.
+inline uint8_t* write_varint(uint64_t value, uint8_t* out) {
+  while (value >= 0x80) {
+    *out++ = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<uint8_t>(value);
+  return out;
+}
+
+// Отображение знаковых чисел в беззнаковые так, чтобы малые по модулю числа кодировались коротко.
+inline uint64_t zigzag_encode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Читает одно число из [@in, @end) в @value.
+// Возвращает указатель за последним прочитанным байтом или nullptr, если данные некорректны.
+inline const uint8_t* read_varint(const uint8_t* in, const uint8_t* end, uint64_t* value) {
+  if (static_cast<size_t>(end - in) >= kMaxVarintSize) {
+    return impl::read_varint_unchecked(in, value);
+  }
+  return impl::read_varint_checked(in, end, value);
+}
+
+// Читает @count чисел из [@in, @end) в массив @out.
+// Если 8 подряд идущих чисел однобайтовые, они декодируются одним словом.
+// Возвращает указатель за последним прочитанным байтом или nullptr, если данные некорректны.
+template <typename T>
+inline const uint8_t* read_varint_vector(const uint8_t* in, const uint8_t* end, T* out, size_t count) {
+  while (count > 0 && static_cast<size_t>(end - in) >= kMaxVarintSize) {
+    if (count >= 8) {
+      const uint64_t word = impl::load_word(in);
+      if (!(word & impl::kVarintContinuationBits)) {
+        for (int i = 0; i < 8; ++i) {
+          out[i] = static_cast<T>((word >> (8 * i)) & 0xFF);
+        }
+        in += 8;
+        out += 8;
+        count -= 8;
+        continue;
+      }
+    }
+    uint64_t value;
+    in = impl::read_varint_unchecked(in, &value);
+    if (!in) {
+      return nullptr;
+    }
+    *out++ = static_cast<T>(value);
+    --count;
+  }
+  for (; count > 0; --count) {
+    uint64_t value;
+    in = impl::read_varint_checked(in, end, &value);
+    if (!in) {
+      return nullptr;
+    }
+    *out++ = static_cast<T>(value);
+  }
+  return in;
+}
+
+// Записывает @count чисел из массива @values в @out.
+// Возвращает указатель за последним записанным байтом.
+template <typename T>
+inline uint8_t* write_varint_vector(const T* values, size_t count, uint8_t* out) {
+  for (size_t i = 0; i < count; ++i) {
+    out = write_varint(static_cast<uint64_t>(values[i]), out);
+  }
+  return out;
+}
+
+}  // namespace hftbattle
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include "base/json.h"
+#include "base/perf_time.h"
+
+namespace hftbattle {
+
+/**
+ * BookUpdateConflator объединяет частые апдейты стакана в один.
+ * Апдейт считается обработанным, если с момента предыдущего обработанного апдейта
+ * прошло не меньше @window биржевого времени или накопилось @max_events апдейтов.
+ * Пропущенные апдейты не теряются: стакан и trading_book_info всегда содержат
+ * последнее состояние, поэтому обработанный апдейт видит все накопленные изменения.
+ * Сведение наших заявок симуляция выполняет на каждом апдейте независимо от этого класса.
+ *
+ * Пример использования в стратегии:
+ *   void trading_book_update(const OrderBook& order_book) override {
+ *     if (!conflator_.should_process(order_book.get_server_time())) {
+ *       return;
+ *     }
+ *     process_book();
+ *   }
+ *
+ * Если поток апдейтов закончился (конец дня, остановка стратегии) на отложенном апдейте,
+ * последнее состояние стакана нужно обработать явно:
+ *   if (conflator_.flush()) {
+ *     process_book();
+ *   }
+ *
+ * Параметры можно задать в конфиге стратегии:
+ * "conflation_window_us" - окно в микросекундах (по умолчанию 0 - без окна),
+ * "conflation_events" - максимальное число апдейтов в окне (по умолчанию 0 - без ограничения).
+ * Если не задан ни один параметр, обрабатывается каждый апдейт.
+ **/
+class BookUpdateConflator {
+public:
+  BookUpdateConflator(Microseconds window, int32_t max_events)
+    : window_(window), max_events_(max_events) {
+  }
+
+  explicit BookUpdateConflator(const JsonValue& config)
+    : BookUpdateConflator(config["conflation_window_us"].as<Microseconds>(Microseconds(0)),
+                          config["conflation_events"].as<int32_t>(0)) {
+  }
+
+  // Возвращает true, если апдейт с биржевым временем @server_time нужно обработать.
+  bool should_process(Microseconds server_time) {
+    ++pending_events_;
+    const bool conflation_enabled = window_ > Microseconds(0) || max_events_ > 0;
+    const bool window_passed = window_ > Microseconds(0) &&
+                               server_time - last_processed_time_ >= window_;
+    const bool enough_events = max_events_ > 0 && pending_events_ >= max_events_;
+    if (conflation_enabled && !window_passed && !enough_events) {
+      ++skipped_events_;
+      return false;
+    }
+    last_processed_time_ = server_time;
+    pending_events_ = 0;
+    return true;
+  }
+
+  // Есть ли отложенные апдейты, которые еще не были обработаны.
+  bool has_pending() const {
+    return pending_events_ > 0;
+  }
+
+  // Завершает текущее окно. Возвращает true, если в нем были отложенные апдейты:
+  // тогда вызывающий должен обработать последнее состояние стакана.
+  bool flush() {
+    const bool pending = has_pending();
+    pending_events_ = 0;
+    return pending;
+  }
+
+  // Количество апдейтов, объединенных с последующими с начала дня.
+  int64_t skipped_events() const {
+    return skipped_events_;
+  }
+
+private:
+  const Microseconds window_;
+  const int32_t max_events_;
+  Microseconds last_processed_time_ = Microseconds(0);
+  int32_t pending_events_ = 0;
+  int64_t skipped_events_ = 0;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./participant_strategy.h"
+
+namespace hftbattle {
+
+/**
+ * ChartDecimator прореживает точки графиков перед передачей в add_chart_point.
+ * Биржевое время делится на интервалы длины @resolution; по каждой линии за интервал
+ * на график выводятся не более трех точек - минимум, максимум (в порядке их появления)
+ * и последнее значение. Так форма графика сохраняется, а размер вывода ограничен
+ * числом интервалов, сколько бы точек стратегия ни добавляла на каждом апдейте.
+ *
+ * add_chart_point ставит точку на текущее биржевое время, поэтому точки интервала
+ * выводятся сразу после его окончания: при первом вызове advance (его нужно вызывать
+ * на каждом апдейте, например в начале trading_book_update) или add_point с временем
+ * из следующего интервала. Без advance точки редкой линии попадут на график с опозданием -
+ * в момент ее следующей точки. Точки последнего интервала выводятся только явным
+ * вызовом flush; деструктор их не выводит, так как при разрушении стратегии
+ * график может быть уже недоступен.
+ *
+ * Линию можно задавать по имени или заранее получить ее номер методом line,
+ * чтобы не искать линию по имени на каждой точке.
+ * Интервал можно задать в конфиге стратегии: "chart_resolution_us"
+ * (по умолчанию 0 - прореживание выключено, все точки выводятся сразу).
+ **/
+class ChartDecimator {
+public:
+  using LineId = size_t;
+
+  ChartDecimator(ParticipantStrategy* strategy, Microseconds resolution)
+    : strategy_(strategy), resolution_(resolution) {
+  }
+
+  ChartDecimator(ParticipantStrategy* strategy, const JsonValue& config)
+    : ChartDecimator(strategy, config["chart_resolution_us"].as<Microseconds>(Microseconds(0))) {
+  }
+
+  // Номер линии @line_name на оси @y_axis_type картинки @chart_number.
+  LineId line(const std::string& line_name, ChartYAxisType y_axis_type, uint8_t chart_number) {
+    auto it = ids_.find(line_name);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    lines_.push_back(Line{line_name, y_axis_type, chart_number});
+    return ids_.emplace(line_name, lines_.size() - 1).first->second;
+  }
+
+  // Добавляет точку со значением @value на линию @line в текущее биржевое время.
+  void add_point(LineId line_id, double value) {
+    Line& line = lines_[line_id];
+    if (resolution_ <= Microseconds(0)) {
+      strategy_->add_chart_point(line.name, value, line.y_axis_type, line.chart_number);
+      return;
+    }
+    const int64_t bucket = strategy_->get_server_time() / resolution_;
+    if (line.points_count > 0 && bucket != line.bucket) {
+      flush_line(line);
+    }
+    line.bucket = bucket;
+    if (line.points_count == 0 || value < line.min) {
+      line.min = value;
+      line.min_index = line.points_count;
+    }
+    if (line.points_count == 0 || value > line.max) {
+      line.max = value;
+      line.max_index = line.points_count;
+    }
+    line.last = value;
+    ++line.points_count;
+  }
+
+  // Выводит точки интервалов, закончившихся к биржевому времени @server_time.
+  void advance(Microseconds server_time) {
+    if (resolution_ <= Microseconds(0)) {
+      return;
+    }
+    const int64_t bucket = server_time / resolution_;
+    for (Line& line : lines_) {
+      if (line.points_count > 0 && line.bucket != bucket) {
+        flush_line(line);
+      }
+    }
+  }
+
+  void add_point(const std::string& line_name, double value,
+                 ChartYAxisType y_axis_type, uint8_t chart_number) {
+    add_point(line(line_name, y_axis_type, chart_number), value);
+  }
+
+  // Выводит накопленные точки всех линий.
+  void flush() {
+    for (Line& line : lines_) {
+      if (line.points_count > 0) {
+        flush_line(line);
+      }
+    }
+  }
+
+private:
+  struct Line {
+    std::string name;
+    ChartYAxisType y_axis_type;
+    uint8_t chart_number;
+    int64_t bucket = 0;
+    int32_t points_count = 0;
+    int32_t min_index = 0;
+    int32_t max_index = 0;
+    double min = 0;
+    double max = 0;
+    double last = 0;
+  };
+
+  void flush_line(Line& line) {
+    const int32_t last_index = line.points_count - 1;
+    // Точки с индексами min_index, max_index и last_index в порядке появления, без повторов.
+    const bool min_first = line.min_index <= line.max_index;
+    const int32_t first_index = min_first ? line.min_index : line.max_index;
+    const int32_t second_index = min_first ? line.max_index : line.min_index;
+    draw(line, min_first ? line.min : line.max);
+    if (second_index != first_index) {
+      draw(line, min_first ? line.max : line.min);
+    }
+    if (last_index != second_index) {
+      draw(line, line.last);
+    }
+    line.points_count = 0;
+  }
+
+  void draw(const Line& line, double value) {
+    strategy_->add_chart_point(line.name, value, line.y_axis_type, line.chart_number);
+  }
+
+  ParticipantStrategy* strategy_;
+  const Microseconds resolution_;
+  std::vector<Line> lines_;
+  std::unordered_map<std::string, LineId> ids_;
+};
+
+}  // namespace hftbattle
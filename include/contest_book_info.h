@@ -30,6 +30,7 @@ public:
 
   // Ссылка на структуру, содержащая наши текущие заявки.
   SecurityOrdersSnapshot& orders() { return orders_; }
+  const SecurityOrdersSnapshot& orders() const { return orders_; }
 
   // Полусумма лучших цен.
   Price middle_price() const { return middle_price_; }
@@ -0,0 +1,173 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "./deal.h"
+#include "base/common_enums.h"
+#include "base/ring_buffer.h"
+
+namespace hftbattle {
+
+// Статистика сделок в скользящем окне по направлению агрессора.
+struct DealWindowStats {
+  std::array<int32_t, 2> count{{0, 0}};
+  std::array<int64_t, 2> volume{{0, 0}};
+  // Сумма цена * объем в единицах числителя Decimal.
+  std::array<int64_t, 2> notional{{0, 0}};
+
+  int32_t total_count() const {
+    return count[BID] + count[ASK];
+  }
+
+  int64_t total_volume() const {
+    return volume[BID] + volume[ASK];
+  }
+
+  // Средневзвешенная по объему цена сделок (0, если сделок нет).
+  Price vwap() const {
+    const int64_t total = total_volume();
+    return total == 0 ? Price() : Price::from_numerator((notional[BID] + notional[ASK]) / total);
+  }
+
+  // Разность количества сделок покупателей и продавцов.
+  int32_t count_imbalance() const {
+    return count[BID] - count[ASK];
+  }
+
+  // Доля объема покупателей минус доля объема продавцов, от -1 до 1 (0, если сделок нет).
+  double volume_imbalance() const {
+    const int64_t total = total_volume();
+    return total == 0 ? 0.0 : static_cast<double>(volume[BID] - volume[ASK]) / total;
+  }
+};
+
+/**
+ * DealWindows поддерживает статистику сделок (количество, объем, оборот, VWAP, дисбаланс
+ * по направлениям) сразу в нескольких скользящих окнах по биржевому времени.
+ * Окно длины @length на момент now содержит сделки со временем из (now - @length, now].
+ *
+ * Сделки хранятся один раз в общем кольцевом буфере; у каждого окна есть только
+ * указатель на первую свою сделку и накопленные суммы. Каждая сделка один раз добавляется
+ * в суммы и один раз вычитается из сумм каждого окна, поэтому обработка сделки и сдвиг
+ * окон стоят амортизированно O(число окон), а чтение статистики - O(1).
+ *
+ * Использование: окна добавляются методом add_window до начала торговли,
+ * add_deals вызывается из trading_deals_update (или signal_deals_update),
+ * advance - при необходимости сдвинуть окна без новых сделок (например, на апдейте стакана).
+ **/
+class DealWindows {
+public:
+  using WindowId = size_t;
+
+  // Добавляет окно длины @length. Возвращает его номер.
+  WindowId add_window(Microseconds length) {
+    windows_.push_back(Window{length, first_sequence_ + deals_.size(), DealWindowStats()});
+    return windows_.size() - 1;
+  }
+
+  // Добавляет сделки @deals и сдвигает окна на время последней из них.
+  void add_deals(const std::vector<Deal>& deals) {
+    for (const Deal& deal : deals) {
+      add_deal(deal.dir, deal.price, deal.amount, deal.server_time);
+    }
+    if (!deals.empty()) {
+      advance(deals.back().server_time);
+    }
+  }
+
+  // Добавляет сделку агрессора @dir объемом @amount по цене @price во время @server_time.
+  // Окна при этом не сдвигаются.
+  void add_deal(Dir dir, Price price, Amount amount, Microseconds server_time) {
+    const int64_t notional = price.get_numerator() * amount;
+    deals_.push_back(Entry{server_time, notional, amount, dir});
+    for (Window& window : windows_) {
+      window.stats.count[dir] += 1;
+      window.stats.volume[dir] += amount;
+      window.stats.notional[dir] += notional;
+    }
+  }
+
+  // Сдвигает окна на время @now: из них удаляются сделки со временем не больше now - длина окна.
+  void advance(Microseconds now) {
+    uint64_t min_first = first_sequence_ + deals_.size();
+    for (Window& window : windows_) {
+      const Microseconds border = now - window.length;
+      while (window.first < first_sequence_ + deals_.size()) {
+        const Entry& entry = deals_[window.first - first_sequence_];
+        if (entry.server_time > border) {
+          break;
+        }
+        window.stats.count[entry.dir] -= 1;
+        window.stats.volume[entry.dir] -= entry.amount;
+        window.stats.notional[entry.dir] -= entry.notional;
+        ++window.first;
+      }
+      min_first = std::min(min_first, window.first);
+    }
+    // Сделки, не входящие ни в одно окно, больше не нужны.
+    deals_.pop_front(min_first - first_sequence_);
+    first_sequence_ = min_first;
+  }
+
+  const DealWindowStats& stats(WindowId id) const {
+    return windows_[id].stats;
+  }
+
+  size_t windows_count() const {
+    return windows_.size();
+  }
+
+private:
+  struct Entry {
+    Microseconds server_time;
+    int64_t notional;
+    Amount amount;
+    Dir dir;
+  };
+
+  struct Window {
+    Microseconds length;
+    // Порядковый номер первой сделки окна.
+    uint64_t first;
+    DealWindowStats stats;
+  };
+
+  RingBuffer<Entry> deals_;
+  // Порядковый номер сделки в начале буфера.
+  uint64_t first_sequence_ = 0;
+  std::vector<Window> windows_;
+};
+
+/**
+ * DecayingSum - сумма с экспоненциальным затуханием: вклад значения, добавленного
+ * в момент t, к моменту now равен value * exp(-(now - t) / @tau). Хранит одно число,
+ * добавление и чтение стоят O(1).
+ **/
+class DecayingSum {
+public:
+  explicit DecayingSum(Microseconds tau) : tau_us_(static_cast<double>(tau.count())) {}
+
+  // Добавляет @value в момент @time (моменты должны не убывать).
+  void add(Microseconds time, double value) {
+    value_ = value_at(time) + value;
+    time_ = time;
+  }
+
+  // Значение суммы в момент @time.
+  double value_at(Microseconds time) const {
+    if (time <= time_ || value_ == 0.0) {
+      return value_;
+    }
+    return value_ * std::exp(-static_cast<double>((time - time_).count()) / tau_us_);
+  }
+
+private:
+  const double tau_us_;
+  double value_ = 0.0;
+  Microseconds time_ = Microseconds(0);
+};
+
+}  // namespace hftbattle
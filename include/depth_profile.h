@@ -0,0 +1,135 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "./order_book.h"
+
+namespace hftbattle {
+
+/**
+ * DepthProfile отвечает на запросы о накопленном объеме стакана: сколько лотов стоит
+ * не хуже заданной цены, до какой цены нужно пройти стакан, чтобы набрать заданный объем,
+ * и сколько это будет стоить.
+ *
+ * Профиль строится один раз на апдейт (update) за один проход по котировкам: для каждого
+ * направления запоминаются цены уровней и префиксные суммы объема и оборота. После этого
+ * каждый запрос - двоичный поиск, O(log n) по числу уровней, без обхода all_quotes.
+ * Память для профиля выделяется только при росте глубины стакана.
+ *
+ * Направление @dir в запросах - сторона стакана: для оценки покупки нужно спрашивать ASK.
+ **/
+class DepthProfile {
+public:
+  // Перестраивает профиль по стакану @order_book.
+  void update(const OrderBook& order_book) {
+    for (Dir dir : {BID, ASK}) {
+      Side& side = sides_[dir];
+      side.prices.clear();
+      side.volumes.clear();
+      side.notionals.clear();
+      int64_t volume = 0;
+      int64_t notional = 0;
+      for (const Quote& quote : order_book.all_quotes(dir)) {
+        if (quote.get_volume() <= 0) {
+          continue;
+        }
+        volume += quote.get_volume();
+        notional += quote.get_price().get_numerator() * quote.get_volume();
+        side.prices.push_back(quote.get_price());
+        side.volumes.push_back(volume);
+        side.notionals.push_back(notional);
+      }
+    }
+  }
+
+  // Количество непустых уровней по направлению @dir.
+  size_t levels_count(Dir dir) const {
+    return sides_[dir].prices.size();
+  }
+
+  // Суммарный объем всех уровней по направлению @dir.
+  int64_t total_volume(Dir dir) const {
+    const Side& side = sides_[dir];
+    return side.volumes.empty() ? 0 : side.volumes.back();
+  }
+
+  // Суммарный объем уровней по направлению @dir с ценой не хуже @price.
+  int64_t volume_up_to_price(Dir dir, Price price) const {
+    const size_t levels = levels_up_to_price(dir, price);
+    return levels == 0 ? 0 : sides_[dir].volumes[levels - 1];
+  }
+
+  // Суммарный объем уровней по направлению @dir не дальше @steps шагов цены @min_step от лучшей цены.
+  int64_t volume_within_steps(Dir dir, int32_t steps, Price min_step) const {
+    const Side& side = sides_[dir];
+    if (side.prices.empty()) {
+      return 0;
+    }
+    const Price offset = min_step * steps;
+    return volume_up_to_price(dir, dir == BID ? side.prices.front() - offset : side.prices.front() + offset);
+  }
+
+  // Худшая цена, до которой нужно пройти уровни по направлению @dir, чтобы набрать объем @volume.
+  // Если объема в стакане не хватает, возвращается цена последнего уровня (см. total_volume);
+  // если уровней нет - цена по умолчанию для направления.
+  Price price_for_volume(Dir dir, int64_t volume) const {
+    const Side& side = sides_[dir];
+    if (side.prices.empty()) {
+      return default_quote_price(dir);
+    }
+    return side.prices[std::min(level_for_volume(dir, volume), side.prices.size() - 1)];
+  }
+
+  // Стоимость (сумма цена * объем) первых @volume лотов по направлению @dir.
+  // Если объема в стакане не хватает, возвращается стоимость всех уровней.
+  Price notional_for_volume(Dir dir, int64_t volume) const {
+    const Side& side = sides_[dir];
+    if (volume <= 0 || side.prices.empty()) {
+      return Price();
+    }
+    const size_t level = level_for_volume(dir, volume);
+    if (level >= side.prices.size()) {
+      return Price::from_numerator(side.notionals.back());
+    }
+    const int64_t volume_before = level == 0 ? 0 : side.volumes[level - 1];
+    const int64_t notional_before = level == 0 ? 0 : side.notionals[level - 1];
+    return Price::from_numerator(notional_before + side.prices[level].get_numerator() * (volume - volume_before));
+  }
+
+  // Средняя цена исполнения первых @volume лотов по направлению @dir.
+  Price average_price_for_volume(Dir dir, int64_t volume) const {
+    const int64_t filled = std::min(volume, total_volume(dir));
+    return filled <= 0 ? Price() : notional_for_volume(dir, filled) / filled;
+  }
+
+private:
+  struct Side {
+    // Цены уровней от лучшей к худшей и префиксные суммы объема и оборота
+    // (оборот - в единицах числителя Decimal).
+    std::vector<Price> prices;
+    std::vector<int64_t> volumes;
+    std::vector<int64_t> notionals;
+  };
+
+  // Количество уровней по направлению @dir с ценой не хуже @price.
+  size_t levels_up_to_price(Dir dir, Price price) const {
+    const auto& prices = sides_[dir].prices;
+    if (dir == BID) {
+      return std::upper_bound(prices.begin(), prices.end(), price, std::greater<Price>()) - prices.begin();
+    }
+    return std::upper_bound(prices.begin(), prices.end(), price) - prices.begin();
+  }
+
+  // Номер первого уровня, на котором накопленный объем достигает @volume.
+  size_t level_for_volume(Dir dir, int64_t volume) const {
+    const auto& volumes = sides_[dir].volumes;
+    return std::lower_bound(volumes.begin(), volumes.end(), volume) - volumes.begin();
+  }
+
+  std::array<Side, 2> sides_;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "./order.h"
+#include "./security_orders_snapshot.h"
+#include "base/string_interner.h"
+
+namespace hftbattle {
+
+enum class OrderActionType : uint8_t {
+  AddLimit,
+  AddIoc,
+  Delete,
+  DeleteAllByDir
+};
+
+struct OrderAction {
+  OrderActionType type;
+  Dir dir;
+  Price price;
+  Amount amount;
+  Order* order;
+  // Комментарий к заявке, см. OrderActions::comment.
+  StringId comment;
+  // Действие взаимно погашено другим действием буфера и не будет отправлено.
+  bool skipped;
+};
+
+/**
+ * OrderActions - буфер действий с нашими заявками (постановка, снятие, перестановка).
+ * Действия накапливаются в течение обработки одного апдейта и отправляются в симуляцию
+ * одним вызовом ParticipantStrategy::submit_order_actions.
+ *
+ * Перед отправкой буфер за один проход убирает лишние транзакции:
+ * - повторное снятие одной и той же заявки и снятие уже снимаемых заявок;
+ * - пары "снять заявку + поставить такую же" (то же направление, цена, остаток и комментарий):
+ *   такая заявка просто остается в стакане и сохраняет свое место в очереди.
+ * Так перестановка лесенки, в которой изменилась пара уровней, стоит пары транзакций,
+ * а не снятия и постановки всей лесенки.
+ *
+ * Комментарии хранятся в буфере в одном экземпляре (StringInterner), поэтому повторяющиеся
+ * комментарии не копируются на каждое действие. Идентификатор комментария можно получить
+ * заранее через intern_comment и передавать вместо строки, но только до отправки буфера:
+ * при очистке буфера очищаются и комментарии, чтобы с уникальными комментариями
+ * (номерами, временем) память не росла в течение дня.
+ *
+ * Буфер стоит хранить в стратегии и переиспользовать между апдейтами:
+ * после отправки он очищается, но сохраняет выделенную память, так что
+ * в установившемся режиме отправка не выделяет память.
+ **/
+class OrderActions {
+public:
+  // Добавляет в буфер постановку лимитной заявки.
+  void add_limit_order(Dir dir, Price price, Amount amount, StringId comment = StringInterner::kEmptyStringId) {
+    push(OrderActionType::AddLimit, dir, price, amount, nullptr, comment);
+  }
+
+  void add_limit_order(Dir dir, Price price, Amount amount, const std::string& comment) {
+    add_limit_order(dir, price, amount, intern_comment(comment));
+  }
+
+  // Добавляет в буфер постановку заявки типа Immediate-Or-Cancel (IOC).
+  void add_ioc_order(Dir dir, Price price, Amount amount, StringId comment = StringInterner::kEmptyStringId) {
+    push(OrderActionType::AddIoc, dir, price, amount, nullptr, comment);
+  }
+
+  void add_ioc_order(Dir dir, Price price, Amount amount, const std::string& comment) {
+    add_ioc_order(dir, price, amount, intern_comment(comment));
+  }
+
+  // Добавляет в буфер снятие заявки @order.
+  void delete_order(Order* order) {
+    push(OrderActionType::Delete, order->dir, order->price, order->amount_rest(), order,
+         StringInterner::kEmptyStringId);
+  }
+
+  // Добавляет в буфер снятие всех наших заявок по направлению @dir.
+  void delete_all_orders_by_dir(Dir dir) {
+    push(OrderActionType::DeleteAllByDir, dir, Price(), 0, nullptr, StringInterner::kEmptyStringId);
+  }
+
+  // Добавляет в буфер перестановку заявки @order на цену @price с объемом @amount.
+  void replace_order(Order* order, Price price, Amount amount,
+                     StringId comment = StringInterner::kEmptyStringId) {
+    delete_order(order);
+    add_limit_order(order->dir, price, amount, comment);
+  }
+
+  void replace_order(Order* order, Price price, Amount amount, const std::string& comment) {
+    replace_order(order, price, amount, intern_comment(comment));
+  }
+
+  // Добавляет в буфер перестановку заявки @order с сохранением ее комментария.
+  // Если цена и остаток не меняются, то при отправке перестановка будет пропущена.
+  void move_order(Order* order, Price price, Amount amount) {
+    replace_order(order, price, amount, intern_comment(order->comment()));
+  }
+
+  // Идентификатор комментария @comment для передачи в методы буфера.
+  // Действителен до очистки буфера (clear или отправка).
+  StringId intern_comment(StringView comment) {
+    return comments_.intern(comment);
+  }
+
+  StringId intern_comment(const std::string& comment) {
+    return comments_.intern(comment);
+  }
+
+  // Текст комментария к действию @action.
+  const std::string& comment(const OrderAction& action) const {
+    return comments_.str(action.comment);
+  }
+
+  bool empty() const {
+    return actions_.empty();
+  }
+
+  size_t size() const {
+    return actions_.size();
+  }
+
+  // Очищает действия и комментарии: полученные ранее идентификаторы комментариев
+  // становятся недействительными.
+  void clear() {
+    actions_.clear();
+    comments_.clear();
+  }
+
+  void reserve(size_t size) {
+    actions_.reserve(size);
+  }
+
+  const std::vector<OrderAction>& actions() const {
+    return actions_;
+  }
+
+  /* Далее служебные методы. */
+
+  // Разворачивает снятия по направлению в снятия конкретных заявок из @orders
+  // и помечает как пропущенные действия, не меняющие наших заявок.
+  void compact(SecurityOrdersSnapshot& orders) {
+    expand_dir_deletes(orders);
+    deleted_.clear();
+    for (auto& action : actions_) {
+      if (action.type != OrderActionType::Delete) {
+        continue;
+      }
+      const OrderStatus status = action.order->status();
+      const bool already_deleted =
+          std::find(deleted_.cbegin(), deleted_.cend(), action.order) != deleted_.cend();
+      if (already_deleted || status == OrderStatus::Deleting || status == OrderStatus::Deleted) {
+        action.skipped = true;
+        continue;
+      }
+      deleted_.push_back(action.order);
+      if (status == OrderStatus::Active) {
+        skip_matching_add(&action);
+      }
+    }
+  }
+
+private:
+  void push(OrderActionType type, Dir dir, Price price, Amount amount, Order* order, StringId comment) {
+    actions_.push_back(OrderAction{type, dir, price, amount, order, comment, false});
+  }
+
+  void expand_dir_deletes(SecurityOrdersSnapshot& orders) {
+    const bool has_dir_deletes = std::any_of(actions_.cbegin(), actions_.cend(),
+        [](const OrderAction& action) { return action.type == OrderActionType::DeleteAllByDir; });
+    if (!has_dir_deletes) {
+      return;
+    }
+    expanded_.clear();
+    for (auto& action : actions_) {
+      if (action.type != OrderActionType::DeleteAllByDir) {
+        expanded_.push_back(std::move(action));
+        continue;
+      }
+      for (OrderSnapshot& snapshot : orders.orders_by_dir[action.dir]) {
+        Order* order = snapshot;
+        expanded_.push_back(OrderAction{OrderActionType::Delete, order->dir, order->price,
+                                        order->amount_rest(), order,
+                                        StringInterner::kEmptyStringId, false});
+      }
+    }
+    actions_.swap(expanded_);
+  }
+
+  // Ищет постановку, полностью совпадающую со снимаемой заявкой, и погашает обе.
+  void skip_matching_add(OrderAction* del) {
+    const Order* order = del->order;
+    for (auto& action : actions_) {
+      if (action.type == OrderActionType::AddLimit && !action.skipped &&
+          action.dir == order->dir && action.price == order->price &&
+          action.amount == order->amount_rest() && comments_.str(action.comment) == order->comment()) {
+        action.skipped = true;
+        del->skipped = true;
+        return;
+      }
+    }
+  }
+
+  std::vector<OrderAction> actions_;
+  // Служебные буферы, переиспользуемые между отправками.
+  std::vector<OrderAction> expanded_;
+  std::vector<Order*> deleted_;
+  StringInterner comments_;
+};
+
+}  // namespace hftbattle
@@ -5,6 +5,7 @@
 #include "./execution_report.h"
 #include "./order_book.h"
 #include "./deal.h"
+#include "./order_actions.h"
 #include "base/macroses.h"
 #include "internal/participant_strategy_initializer_data.h"
 
@@ -99,10 +100,26 @@ public:
   // @order - заявка, которую мы хотим снять.
   void delete_order(Order* order);
 
+  // Переставляет нашу лимитную заявку на новую цену и/или объем:
+  // @order - заявка, которую мы хотим переставить,
+  // @price - новая цена заявки,
+  // @amount - новый размер заявки.
+  // Если заявка активна, а ее цена и остаток не меняются, то заявка остается на месте
+  // и сохраняет свою позицию в очереди. Иначе заявка снимается и ставится заново с тем же
+  // направлением и комментарием - как при явных delete_order и add_limit_order.
+  // Атомарной перестановки нет: новая заявка встает в конец очереди.
+  // Возвращает результат add_limit_order (true, если заявка не переставлялась).
+  bool move_order(Order* order, Price price, Amount amount);
+
   // Снимает все наши заявки с торгов по направлению @dir.
   // @dir - направление (BID = 0 - покупка, ASK = 1 - продажа).
   void delete_all_orders_by_dir(Dir dir);
 
+  // Отправляет в симуляцию действия, накопленные в буфере @actions, и очищает его.
+  // Взаимно погашающиеся действия (снятие и постановка такой же заявки) не отправляются.
+  // Возвращает количество отправленных действий.
+  size_t submit_order_actions(OrderActions& actions);
+
   // Возвращает количество лотов, стоящих в очереди перед нашей заявкой.
   // @order - заявка, для которой мы хотим узнать количество стоящих перед ней лотов.
   Amount get_amount_before_order(Order* order) const;
@@ -124,6 +141,24 @@ public:
   // Возвращает true, если есть сигнальный инструмент. Иначе false.
   bool signal_security_exists() const;
 
+  // Возвращает торговый инструмент.
+  SecurityId trading_security() const {
+    return trading_security_;
+  }
+
+  // Возвращает сигнальный инструмент (nullptr, если его нет).
+  SecurityId signal_security() const {
+    return signal_security_;
+  }
+
+  // Возвращает агрегатор информации о стакане инструмента @security
+  // (торгового или сигнального). Позволяет писать обработку инструментов
+  // единообразно, без разделения на торговый и сигнальный.
+  ContestBookInfo& book_info(SecurityId security);
+
+  // Возвращает текущий стакан инструмента @security (торгового или сигнального).
+  const std::shared_ptr<const OrderBook>& book(SecurityId security) const;
+
   // Возвращает локальное время в микросекундах.
   // Локальное время здесь – это время на машине, получающей биржевые данные.
   Microseconds get_local_time() const;
@@ -162,6 +197,54 @@ public:
   virtual ~ParticipantStrategy();
 };
 
+inline ContestBookInfo& ParticipantStrategy::book_info(SecurityId security) {
+  CHECK(security == trading_security_ || security == signal_security_) << "unknown security: " << security;
+  return security == trading_security_ ? trading_book_info : signal_book_info;
+}
+
+inline const std::shared_ptr<const OrderBook>& ParticipantStrategy::book(SecurityId security) const {
+  CHECK(security == trading_security_ || security == signal_security_) << "unknown security: " << security;
+  return security == trading_security_ ? trading_book : signal_book;
+}
+
+inline bool ParticipantStrategy::move_order(Order* order, Price price, Amount amount) {
+  if (order->status() == OrderStatus::Active && order->price == price && order->amount_rest() == amount) {
+    return true;
+  }
+  // После delete_order заявка может быть уже разрушена.
+  const Dir dir = order->dir;
+  const std::string comment = order->comment();
+  delete_order(order);
+  return add_limit_order(dir, price, amount, comment);
+}
+
+inline size_t ParticipantStrategy::submit_order_actions(OrderActions& actions) {
+  actions.compact(trading_book_info.orders());
+  size_t submitted = 0;
+  for (const OrderAction& action : actions.actions()) {
+    if (action.skipped) {
+      continue;
+    }
+    switch (action.type) {
+      case OrderActionType::AddLimit:
+        add_limit_order(action.dir, action.price, action.amount, actions.comment(action));
+        break;
+      case OrderActionType::AddIoc:
+        add_ioc_order(action.dir, action.price, action.amount, actions.comment(action));
+        break;
+      case OrderActionType::Delete:
+        delete_order(action.order);
+        break;
+      case OrderActionType::DeleteAllByDir:
+        delete_all_orders_by_dir(action.dir);
+        break;
+    }
+    ++submitted;
+  }
+  actions.clear();
+  return submitted;
+}
+
 #define REGISTER_CONTEST_STRATEGY(ClassName, file) \
 extern "C" ParticipantStrategy* make_ ## file (JsonValue config) { \
   ParticipantStrategyInitializerData::set(config); \
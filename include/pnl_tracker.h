@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdlib>
+#include "./contest_book_info.h"
+#include "./execution_report.h"
+#include "base/constants.h"
+#include "base/json.h"
+
+namespace hftbattle {
+
+// Текущее состояние позиции и результата по торговому инструменту.
+struct PnlSnapshot {
+  // Позиция: положительная - купленные лоты, отрицательная - проданные.
+  Amount position = 0;
+  // Средняя цена открытой позиции (0, если позиции нет).
+  Price average_price;
+  // Результат по закрытой части позиции без учета комиссий.
+  Price realized_pnl;
+  // Результат по открытой позиции при ее закрытии по цене mark_price.
+  Price unrealized_pnl;
+  // Комиссии за сделки пассивными (лимитными) и агрессивными (IOC) заявками.
+  Price passive_fee;
+  Price aggressive_fee;
+  // Цена, по которой оценивается открытая позиция (полусумма лучших цен).
+  Price mark_price;
+
+  Price total_fee() const {
+    return passive_fee + aggressive_fee;
+  }
+
+  // Полный результат с учетом открытой позиции и комиссий.
+  Price result() const {
+    return realized_pnl + unrealized_pnl - total_fee();
+  }
+};
+
+/**
+ * PnlTracker поддерживает позицию, среднюю цену, реализованный и нереализованный результат
+ * и комиссии инкрементально: на каждую нашу сделку и на каждое изменение оценочной цены
+ * выполняется O(1) операций, а чтение состояния - это чтение готовой структуры.
+ * Поэтому проверять ограничения риска (например, стоп-лосс по результату) можно на каждом
+ * апдейте, не обращаясь к get_current_result и get_saldo.
+ *
+ * Комиссия задается за один лот: сделки заявок IOC считаются агрессивными, сделки
+ * лимитных заявок - пассивными. Параметры можно задать в конфиге стратегии:
+ * "passive_fee" и "aggressive_fee" (по умолчанию 0).
+ *
+ * Использование: вызывать execution_report_update из execution_report_update стратегии,
+ * book_update - из trading_book_update, а pnl - в любой момент.
+ **/
+class PnlTracker {
+public:
+  PnlTracker(Price passive_fee, Price aggressive_fee)
+    : passive_fee_(passive_fee), aggressive_fee_(aggressive_fee) {
+  }
+
+  explicit PnlTracker(const JsonValue& config)
+    : PnlTracker(config["passive_fee"].as<Decimal>(Decimal()),
+                 config["aggressive_fee"].as<Decimal>(Decimal())) {
+  }
+
+  // Учитывает нашу сделку @execution_report.
+  void execution_report_update(const ExecutionReport& execution_report) {
+    const Order* order = execution_report.order();
+    const bool aggressive = order->time_in_force != OrderTimeInForce::Normal;
+    add_deal(execution_report.dir(), execution_report.deal_price(), execution_report.deal_amount(), aggressive);
+  }
+
+  // Учитывает сделку объемом @amount по цене @price в направлении @dir.
+  void add_deal(Dir dir, Price price, Amount amount, bool aggressive) {
+    const Amount signed_amount = dir == BID ? amount : -amount;
+    cash_ -= price * signed_amount;
+    (aggressive ? pnl_.aggressive_fee : pnl_.passive_fee) += fee(aggressive) * amount;
+
+    const Amount position = pnl_.position;
+    if (position == 0 || (position > 0) == (signed_amount > 0)) {
+      // Позиция открывается или увеличивается.
+      open_cost_ += price * signed_amount;
+    } else if (std::abs(signed_amount) <= std::abs(position)) {
+      // Позиция уменьшается: закрытая часть уходит из открытой по средней цене.
+      open_cost_ -= open_cost_ * std::abs(signed_amount) / std::abs(position);
+    } else {
+      // Позиция переворачивается: остаток сделки открывает позицию по ее цене.
+      open_cost_ = price * (position + signed_amount);
+    }
+    pnl_.position = position + signed_amount;
+    if (pnl_.position == 0) {
+      open_cost_ = Price();
+    }
+    pnl_.average_price = pnl_.position == 0 ? Price() : open_cost_ / pnl_.position;
+    // Деньги, полученные за закрытую часть позиции, за вычетом ее стоимости при открытии.
+    pnl_.realized_pnl = cash_ + open_cost_;
+    update_unrealized();
+  }
+
+  // Обновляет оценочную цену по торговому стакану. Если одна из сторон стакана пуста, ее цена -
+  // цена по умолчанию (0 или kMaxPrice), и оценочная цена остается прежней.
+  void book_update(const ContestBookInfo& book_info) {
+    if (book_info.best_volume(BID) > 0 && book_info.best_volume(ASK) > 0) {
+      mark(book_info.middle_price());
+    }
+  }
+
+  // Устанавливает цену @mark_price, по которой оценивается открытая позиция.
+  void mark(Price mark_price) {
+    if (pnl_.mark_price == mark_price) {
+      return;
+    }
+    pnl_.mark_price = mark_price;
+    update_unrealized();
+  }
+
+  const PnlSnapshot& pnl() const {
+    return pnl_;
+  }
+
+private:
+  Price fee(bool aggressive) const {
+    return aggressive ? aggressive_fee_ : passive_fee_;
+  }
+
+  void update_unrealized() {
+    pnl_.unrealized_pnl = pnl_.mark_price * pnl_.position - open_cost_;
+  }
+
+  const Price passive_fee_;
+  const Price aggressive_fee_;
+  PnlSnapshot pnl_;
+  // Сальдо всех сделок без учета комиссий: продажи минус покупки.
+  Price cash_;
+  // Стоимость открытой позиции по ценам открытия (со знаком позиции).
+  Price open_cost_;
+};
+
+}  // namespace hftbattle
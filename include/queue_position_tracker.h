@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "./participant_strategy.h"
+
+namespace hftbattle {
+
+/**
+ * QueuePositionTracker поддерживает количество лотов, стоящих в очереди перед каждой
+ * нашей активной заявкой торгового инструмента, без обращения к очереди заявок на каждый запрос.
+ *
+ * Для новой заявки позиция один раз запрашивается у симуляции (get_amount_before_order),
+ * далее она только уменьшается:
+ * - на объем сделок по цене заявки, в которых пассивной стороной было ее направление;
+ * - до объема котировки на цене заявки, если котировка уменьшилась (снятия считаются
+ *   стоящими перед нами только в той мере, в какой это неизбежно).
+ * Каждая позиция помнит серверное время, на которое она уже учитывает стакан. Сделки
+ * не позже этого времени уже отражены в объеме котировки и повторно не вычитаются,
+ * поэтому результат не зависит от того, пришел стакан раньше сделок или позже.
+ * Объем котировки берется целиком, без вычета нашей заявки: так оценка верна и тогда,
+ * когда наши заявки в котировку не входят.
+ *
+ * При очереди по времени (FIFO) оценка не занижает реальную позицию и совпадает с ней,
+ * пока снятия приходятся на заявки, стоящие за нами. Метод resync заново запрашивает
+ * точные значения у симуляции.
+ *
+ * Использование: вызывать book_update из trading_book_update, deals_update из
+ * trading_deals_update, а amount_before - в любой момент.
+ **/
+class QueuePositionTracker {
+public:
+  explicit QueuePositionTracker(ParticipantStrategy* strategy) : strategy_(strategy) {}
+
+  // Количество лотов в очереди перед заявкой @order.
+  Amount amount_before(Order* order) {
+    auto it = positions_.find(order);
+    if (it == positions_.end()) {
+      it = positions_.emplace(order, query_position(order)).first;
+    }
+    return it->second.amount_before;
+  }
+
+  // Количество отслеживаемых заявок.
+  size_t size() const {
+    return positions_.size();
+  }
+
+  // Обновляет позиции по новому стакану @order_book: начинает отслеживать новые заявки
+  // и забывает о заявках, которые больше не активны.
+  void book_update(const OrderBook& order_book) {
+    ++generation_;
+    auto& orders = strategy_->trading_book_info.orders();
+    for (Dir dir : {BID, ASK}) {
+      for (OrderSnapshot& snapshot : orders.orders_by_dir[dir]) {
+        Order* order = snapshot;
+        if (order->status() != OrderStatus::Active) {
+          continue;
+        }
+        auto it = positions_.find(order);
+        if (it == positions_.end()) {
+          positions_.emplace(order, query_position(order));
+          continue;
+        }
+        Position& position = it->second;
+        position.generation = generation_;
+        const Amount level_volume = order_book.contains_price(dir, order->price)
+                                    ? order_book.get_volume_by_price(dir, order->price)
+                                    : 0;
+        position.amount_before = std::min(position.amount_before, level_volume);
+        position.book_time = std::max(position.book_time, order_book.get_server_time());
+      }
+    }
+    for (auto it = positions_.begin(); it != positions_.end();) {
+      if (it->second.generation != generation_) {
+        it = positions_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  // Уменьшает позиции заявок на объем сделок @deals, прошедших по их ценам.
+  void deals_update(const std::vector<Deal>& deals) {
+    if (positions_.empty()) {
+      return;
+    }
+    for (const Deal& deal : deals) {
+      const Dir passive_dir = opposite_dir(deal.dir);
+      for (auto& item : positions_) {
+        const Order* order = item.first;
+        if (order->dir == passive_dir && order->price == deal.price &&
+            deal.server_time > item.second.book_time) {
+          item.second.amount_before = std::max(item.second.amount_before - deal.amount, 0);
+        }
+      }
+    }
+  }
+
+  // Заново запрашивает у симуляции точные позиции всех отслеживаемых заявок.
+  void resync() {
+    for (auto& item : positions_) {
+      const Position position = query_position(item.first);
+      item.second.amount_before = position.amount_before;
+      item.second.book_time = position.book_time;
+    }
+  }
+
+private:
+  struct Position {
+    Amount amount_before;
+    // Серверное время, по состоянию на которое amount_before уже учитывает стакан.
+    Microseconds book_time;
+    uint64_t generation;
+  };
+
+  // Точная позиция заявки @order на текущий момент.
+  Position query_position(Order* order) const {
+    return Position{strategy_->get_amount_before_order(order), strategy_->get_server_time(), generation_};
+  }
+
+  ParticipantStrategy* strategy_;
+  std::unordered_map<Order*, Position> positions_;
+  uint64_t generation_ = 0;
+};
+
+}  // namespace hftbattle
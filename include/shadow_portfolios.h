@@ -0,0 +1,92 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "./contest_book_info.h"
+#include "base/constants.h"
+
+namespace hftbattle {
+
+/**
+ * ShadowPortfolios - K виртуальных счетов для оценки K вариантов параметров стратегии
+ * за один проход по данным. Заявки вариантов не отправляются в симуляцию, а сводятся
+ * с текущим стаканом по упрощенной модели: заявка IOC исполняется по лучшей встречной
+ * цене в пределах объема на ней, если ее цена не хуже лучшей встречной.
+ * Влияние заявок на стакан и очередь не учитывается, поэтому результаты вариантов -
+ * оценка для отбора параметров, а не замена полноценной симуляции.
+ *
+ * Состояние хранится по колонкам (структура массивов): позиции, денежные потоки
+ * и счетчики сделок всех вариантов лежат в отдельных непрерывных массивах, так что
+ * циклы по вариантам в стратегии и здесь векторизуются компилятором.
+ **/
+class ShadowPortfolios {
+public:
+  explicit ShadowPortfolios(size_t variants_count)
+    : positions_(variants_count, 0),
+      cash_(variants_count, 0),
+      deals_count_(variants_count, 0),
+      volume_(variants_count, 0) {
+  }
+
+  size_t size() const {
+    return positions_.size();
+  }
+
+  // Исполняет заявку IOC варианта @variant по стакану @book_info.
+  // Возвращает исполненный объем.
+  Amount add_ioc_order(size_t variant, Dir dir, Price price, Amount amount, const ContestBookInfo& book_info) {
+    const Dir opposite = opposite_dir(dir);
+    const Price best_price = book_info.best_price(opposite);
+    const bool crosses = dir == BID ? price >= best_price : price <= best_price;
+    const Amount filled = crosses ? std::min(amount, book_info.best_volume(opposite)) : 0;
+    if (filled > 0) {
+      add_deal(variant, dir, best_price, filled);
+    }
+    return filled;
+  }
+
+  // Учитывает сделку варианта @variant.
+  void add_deal(size_t variant, Dir dir, Price price, Amount amount) {
+    const int64_t signed_amount = dir == BID ? amount : -amount;
+    positions_[variant] += signed_amount;
+    cash_[variant] -= price.get_numerator() * signed_amount;
+    deals_count_[variant] += 1;
+    volume_[variant] += amount;
+  }
+
+  int64_t position(size_t variant) const {
+    return positions_[variant];
+  }
+
+  int32_t deals_count(size_t variant) const {
+    return deals_count_[variant];
+  }
+
+  int64_t volume(size_t variant) const {
+    return volume_[variant];
+  }
+
+  // Результат варианта @variant при оценке открытой позиции по цене @mark_price.
+  Price result(size_t variant, Price mark_price) const {
+    return Price::from_numerator(cash_[variant] + mark_price.get_numerator() * positions_[variant]);
+  }
+
+  // Результаты всех вариантов при оценке открытых позиций по цене @mark_price.
+  void results(Price mark_price, std::vector<Price>* results) const {
+    results->resize(size());
+    const int64_t mark = mark_price.get_numerator();
+    for (size_t i = 0; i < size(); ++i) {
+      (*results)[i] = Price::from_numerator(cash_[i] + mark * positions_[i]);
+    }
+  }
+
+private:
+  std::vector<int64_t> positions_;
+  // Сальдо сделок в единицах числителя Decimal: продажи минус покупки.
+  std::vector<int64_t> cash_;
+  std::vector<int32_t> deals_count_;
+  std::vector<int64_t> volume_;
+};
+
+}  // namespace hftbattle
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "base/log.h"
+#include "base/perf_time.h"
+
+namespace hftbattle {
+
+/**
+ * TimerWheel - таймеры по биржевому времени на иерархическом колесе.
+ * Время делится на такты длины @resolution; номер такта раскладывается на разряды
+ * по 6 бит, каждому разряду соответствует уровень колеса из 64 ячеек. Таймер лежит
+ * на уровне старшего разряда, которым его такт отличается от текущего, и спускается
+ * на нижние уровни по мере приближения времени. Поиск ближайшей непустой ячейки
+ * выполняется по битовой маске уровня, поэтому advance без сработавших таймеров
+ * стоит несколько проверок масок, сколько бы времени ни прошло с прошлого вызова,
+ * а постановка и отмена таймера стоят O(1).
+ *
+ * Такт определяет только ячейку колеса: таймер срабатывает, когда время advance не меньше
+ * времени таймера, а не начала его такта. Таймеры срабатывают в advance в порядке времени
+ * (при равном времени - в порядке постановки); для этого ячейки нижнего уровня упорядочены
+ * по времени, и при @resolution больше 1 мкс постановка таймера в такт, где уже есть
+ * таймеры с большим временем, стоит O(число таких таймеров).
+ * Обработчик получает время, на которое таймер был назначен. Симуляция не вызывает
+ * стратегию без биржевых событий, поэтому advance нужно вызывать в начале каждого
+ * апдейта с текущим биржевым временем: таймер сработает на первом событии, время
+ * которого не меньше времени таймера, но с точным временем срабатывания.
+ *
+ * Пример:
+ *   timers_.schedule_every(10ms, [this](Microseconds) { reset_counters(); });
+ *   ...
+ *   void trading_deals_update(const std::vector<Deal>& deals) override {
+ *     timers_.advance(get_server_time());
+ *     ...
+ *   }
+ **/
+class TimerWheel {
+public:
+  using TimerId = uint64_t;
+  using Callback = std::function<void(Microseconds)>;
+
+  static constexpr TimerId kInvalidTimerId = 0;
+
+  explicit TimerWheel(Microseconds resolution = Microseconds(1))
+    : resolution_(resolution.count() > 0 ? resolution.count() : 1) {
+    for (auto& level : slots_) {
+      level.fill(Slot{kNil, kNil});
+    }
+    masks_.fill(0);
+  }
+
+  // Назначает однократный вызов @callback на биржевое время @time.
+  // Если время уже наступило, таймер сработает при следующем вызове advance.
+  TimerId schedule_at(Microseconds time, Callback callback) {
+    return schedule(time, Microseconds(0), std::move(callback));
+  }
+
+  // Назначает вызов @callback каждые @period начиная с @first_time.
+  TimerId schedule_every(Microseconds first_time, Microseconds period, Callback callback) {
+    CHECK(period.count() > 0) << "timer period must be positive";
+    return schedule(first_time, period, std::move(callback));
+  }
+
+  // Назначает вызов @callback каждые @period начиная с now() + @period.
+  TimerId schedule_every(Microseconds period, Callback callback) {
+    return schedule_every(now_ + period, period, std::move(callback));
+  }
+
+  // Отменяет таймер @id. Возвращает false, если таймер уже сработал или отменен.
+  bool cancel(TimerId id) {
+    const uint32_t index = static_cast<uint32_t>(id);
+    if (index >= timers_.size() || timers_[index].generation != static_cast<uint32_t>(id >> 32) ||
+        !timers_[index].active) {
+      return false;
+    }
+    unlink(index);
+    release(index);
+    return true;
+  }
+
+  // Вызывает обработчики всех таймеров со временем не больше @now.
+  void advance(Microseconds now) {
+    if (now < now_) {
+      return;
+    }
+    now_ = now;
+    const uint64_t target = to_tick(now);
+    while (active_count_ > 0) {
+      int level;
+      uint64_t next;
+      if (!next_tick(&level, &next) || next > target) {
+        break;
+      }
+      current_tick_ = next;
+      const uint32_t slot = digit(next, level);
+      if (level > 0) {
+        // Таймеры ячейки спускаются на нижние уровни относительно нового текущего такта.
+        while (slots_[level][slot].head != kNil) {
+          const uint32_t index = slots_[level][slot].head;
+          unlink(index);
+          link(index);
+        }
+        continue;
+      }
+      while (slots_[0][slot].head != kNil) {
+        const uint32_t index = slots_[0][slot].head;
+        if (timers_[index].time > now) {
+          break;
+        }
+        unlink(index);
+        fire(index);
+      }
+      if (slots_[0][slot].head != kNil) {
+        // Остались таймеры текущего такта, время которых еще не наступило.
+        break;
+      }
+    }
+  }
+
+  // Время последнего вызова advance.
+  Microseconds now() const {
+    return now_;
+  }
+
+  // Количество назначенных таймеров.
+  size_t size() const {
+    return active_count_;
+  }
+
+private:
+  static constexpr int kSlotBits = 6;
+  static constexpr uint32_t kSlotsCount = 1u << kSlotBits;
+  static constexpr int kLevelsCount = (64 + kSlotBits - 1) / kSlotBits;
+  static constexpr uint32_t kNil = UINT32_MAX;
+
+  struct Timer {
+    Microseconds time;
+    Microseconds period;
+    Callback callback;
+    uint64_t tick;
+    uint32_t prev;
+    uint32_t next;
+    uint32_t generation;
+    uint8_t level;
+    bool active;
+  };
+
+  struct Slot {
+    uint32_t head;
+    uint32_t tail;
+  };
+
+  static uint32_t digit(uint64_t tick, int level) {
+    return static_cast<uint32_t>(tick >> (kSlotBits * level)) & (kSlotsCount - 1);
+  }
+
+  uint64_t to_tick(Microseconds time) const {
+    return time.count() > 0 ? static_cast<uint64_t>(time.count()) / resolution_ : 0;
+  }
+
+  TimerId schedule(Microseconds time, Microseconds period, Callback callback) {
+    uint32_t index;
+    if (free_.empty()) {
+      index = static_cast<uint32_t>(timers_.size());
+      timers_.emplace_back();
+      timers_.back().generation = 1;
+    } else {
+      index = free_.back();
+      free_.pop_back();
+    }
+    Timer& timer = timers_[index];
+    timer.time = time;
+    timer.period = period;
+    timer.callback = std::move(callback);
+    timer.tick = std::max(to_tick(time), current_tick_);
+    timer.active = true;
+    ++active_count_;
+    link(index);
+    return (static_cast<TimerId>(timer.generation) << 32) | index;
+  }
+
+  void release(uint32_t index) {
+    Timer& timer = timers_[index];
+    timer.active = false;
+    timer.callback = nullptr;
+    // Поколение 0 не выдается, поэтому идентификатор таймера никогда не равен kInvalidTimerId.
+    timer.generation = timer.generation + 1 ? timer.generation + 1 : 1;
+    free_.push_back(index);
+    --active_count_;
+  }
+
+  void fire(uint32_t index) {
+    Timer& timer = timers_[index];
+    const Microseconds time = timer.time;
+    if (timer.period.count() > 0) {
+      // Периодический таймер назначается на следующий период до вызова обработчика,
+      // чтобы обработчик мог его отменить. Отставший таймер остается в текущем такте
+      // и срабатывает в этом же advance за каждый пропущенный период.
+      const uint32_t generation = timer.generation;
+      timer.time += timer.period;
+      timer.tick = std::max(to_tick(timer.time), current_tick_);
+      link(index);
+      Callback callback = std::move(timer.callback);
+      callback(time);
+      // Обработчик мог назначить новые таймеры (timers_ могли переехать) или отменить этот.
+      Timer& rescheduled = timers_[index];
+      if (rescheduled.active && rescheduled.generation == generation) {
+        rescheduled.callback = std::move(callback);
+      }
+      return;
+    }
+    Callback callback = std::move(timer.callback);
+    release(index);
+    callback(time);
+  }
+
+  // Кладет таймер в ячейку старшего разряда, которым его такт отличается от текущего.
+  // В ячейке нижнего уровня таймер встает после всех таймеров с временем не больше своего.
+  void link(uint32_t index) {
+    Timer& timer = timers_[index];
+    const uint64_t diff = timer.tick ^ current_tick_;
+    int level = 0;
+    while (level + 1 < kLevelsCount && (diff >> (kSlotBits * (level + 1))) != 0) {
+      ++level;
+    }
+    const uint32_t slot_index = digit(timer.tick, level);
+    Slot& slot = slots_[level][slot_index];
+    timer.level = static_cast<uint8_t>(level);
+    uint32_t prev = slot.tail;
+    if (level == 0) {
+      while (prev != kNil && timers_[prev].time > timer.time) {
+        prev = timers_[prev].prev;
+      }
+    }
+    const uint32_t next = prev != kNil ? timers_[prev].next : slot.head;
+    timer.prev = prev;
+    timer.next = next;
+    (prev != kNil ? timers_[prev].next : slot.head) = index;
+    (next != kNil ? timers_[next].prev : slot.tail) = index;
+    masks_[level] |= uint64_t(1) << slot_index;
+  }
+
+  void unlink(uint32_t index) {
+    Timer& timer = timers_[index];
+    const uint32_t slot_index = digit(timer.tick, timer.level);
+    Slot& slot = slots_[timer.level][slot_index];
+    (timer.prev != kNil ? timers_[timer.prev].next : slot.head) = timer.next;
+    (timer.next != kNil ? timers_[timer.next].prev : slot.tail) = timer.prev;
+    if (slot.head == kNil) {
+      masks_[timer.level] &= ~(uint64_t(1) << slot_index);
+    }
+  }
+
+  // Ближайший такт, на котором есть работа: срабатывание таймеров нижнего уровня
+  // или спуск ячейки верхнего уровня.
+  bool next_tick(int* level, uint64_t* tick) const {
+    for (int l = 0; l < kLevelsCount; ++l) {
+      const int shift = kSlotBits * l;
+      const uint32_t current = digit(current_tick_, l);
+      // На нижнем уровне подходит и текущая ячейка, на верхних - только следующие.
+      const uint32_t from = l == 0 ? current : current + 1;
+      if (from >= kSlotsCount) {
+        continue;
+      }
+      const uint64_t mask = masks_[l] & (~uint64_t(0) << from);
+      if (mask == 0) {
+        continue;
+      }
+      const uint64_t slot = static_cast<uint64_t>(__builtin_ctzll(mask));
+      const uint64_t high = shift + kSlotBits >= 64 ? 0 : current_tick_ >> (shift + kSlotBits) << (shift + kSlotBits);
+      *level = l;
+      *tick = high | (slot << shift);
+      return true;
+    }
+    return false;
+  }
+
+  const uint64_t resolution_;
+  std::vector<Timer> timers_;
+  std::vector<uint32_t> free_;
+  std::array<std::array<Slot, kSlotsCount>, kLevelsCount> slots_;
+  std::array<uint64_t, kLevelsCount> masks_;
+  uint64_t current_tick_ = 0;
+  Microseconds now_ = Microseconds(0);
+  size_t active_count_ = 0;
+};
+
+}  // namespace hftbattle
@@ -6,9 +6,17 @@ import sys
 import json
 import subprocess
 import platform
+import time
 
 script_path = os.path.dirname(os.path.realpath(__file__))
-config = sys.argv[1]
+build_dir = os.path.join(script_path, 'build')
+
+watch = '--watch' in sys.argv[1:]
+args = [arg for arg in sys.argv[1:] if arg != '--watch']
+if len(args) != 1:
+    print('Usage: %s [--watch] <strategy config>' % sys.argv[0])
+    sys.exit(1)
+config = args[0]
 
 executable_name = ''
 system = platform.system()
@@ -23,6 +31,67 @@ else:
     sys.exit()
 
 executable_path = os.path.join(script_path, executable_name)
-process = subprocess.Popen([executable_path, config], shell=False, stdout=subprocess.PIPE)
-for line in iter(process.stdout.readline, b''):
-    sys.stdout.write(line.decode())
+
+
+def run_simulation():
+    process = subprocess.Popen([executable_path, config], shell=False, stdout=subprocess.PIPE)
+    for line in iter(process.stdout.readline, b''):
+        sys.stdout.write(line.decode())
+    process.wait()
+
+
+if not watch:
+    run_simulation()
+    sys.exit()
+
+# Режим --watch: при изменении исходников стратегии или заголовков пакета пересобирается
+# только цель этой стратегии, после чего симуляция запускается заново.
+# Цель CMake называется по файлу .cpp стратегии, поэтому конфиг должен лежать в папке стратегии
+# рядом с единственным файлом .cpp (имя самого конфига может быть любым).
+strategy_dir = os.path.dirname(os.path.realpath(config))
+strategy_sources = sorted(name for name in os.listdir(strategy_dir) if name.endswith('.cpp'))
+if len(strategy_sources) != 1 or os.path.basename(os.path.dirname(strategy_dir)) != 'strategies':
+    print('--watch: can\'t find the strategy build target for %s' % config)
+    print('The config must be in strategies/<name>/ next to exactly one .cpp file, found: %s'
+          % (', '.join(strategy_sources) or 'none'))
+    sys.exit(1)
+strategy_name = os.path.splitext(strategy_sources[0])[0]
+watched_dirs = [strategy_dir, os.path.join(script_path, 'include')]
+
+if not os.path.exists(os.path.join(build_dir, 'CMakeCache.txt')):
+    print('Build directory is not configured, please run build.py first')
+    sys.exit(1)
+
+
+def sources_state():
+    state = {}
+    for watched_dir in watched_dirs:
+        for root, _, files in os.walk(watched_dir):
+            for name in files:
+                path = os.path.join(root, name)
+                try:
+                    state[path] = os.path.getmtime(path)
+                except OSError:
+                    pass
+    return state
+
+
+def build_strategy():
+    command = ['cmake', '--build', build_dir, '--target', strategy_name]
+    return subprocess.call(command, shell=False) == 0
+
+
+state = None
+try:
+    while True:
+        current_state = sources_state()
+        if current_state != state:
+            state = current_state
+            if build_strategy():
+                run_simulation()
+            else:
+                print('-- Build FAILED, waiting for changes')
+            print('-- Waiting for changes in %s (Ctrl+C to exit)' % ', '.join(watched_dirs))
+        time.sleep(0.5)
+except KeyboardInterrupt:
+    pass
@@ -0,0 +1,117 @@
+#include <cstdlib>
+#include "./participant_strategy.h"
+#include "./shadow_portfolios.h"
+
+using namespace hftbattle;
+
+/**
+ * Данная стратегия - перебор параметра min_deals_count_diff стратегии
+ * deals_count_diff_strategy за один прогон симуляции.
+ * Каждый вариант параметра из списка min_deals_count_diff_values ведет свои счетчики сделок
+ * и свой виртуальный счет (ShadowPortfolios); заявки вариантов в симуляцию не отправляются,
+ * а исполняются по текущему стакану. В конце дня печатается результат каждого варианта.
+ *
+ * Счетчики вариантов хранятся по колонкам, поэтому обновление всех вариантов на каждой
+ * пачке сделок - несколько простых циклов, которые компилятор векторизует.
+ **/
+class UserStrategy : public ParticipantStrategy {
+public:
+  UserStrategy(JsonValue config)
+  : thresholds_(read_thresholds(config))
+  , portfolios_(thresholds_.size())
+  {
+    deals_reset_period_ms_ = config["deals_reset_period_ms"].as<Milliseconds>(10ms);
+    const size_t variants_count = thresholds_.size();
+    bid_counts_.assign(variants_count, 0);
+    ask_counts_.assign(variants_count, 0);
+    last_reset_times_.assign(variants_count, 0);
+    trade_flags_.assign(variants_count, 0);
+
+    std::cout << "variants: " << variants_count << std::endl;
+    std::cout << "deals_reset_period_ms_: " << deals_reset_period_ms_.count() << std::endl;
+  }
+
+  ~UserStrategy() {
+    update_mark_price();
+    for (size_t i = 0; i < thresholds_.size(); ++i) {
+      std::cout << "min_deals_count_diff: " << thresholds_[i]
+                << " deals: " << portfolios_.deals_count(i)
+                << " position: " << portfolios_.position(i)
+                << " result: " << portfolios_.result(i, mark_price_).get_double() << std::endl;
+    }
+  }
+
+  // Вызывается при получении новых сделок торгового инструмента:
+  // @deals - вектор новых сделок.
+  void trading_deals_update(const std::vector<Deal>& deals) override {
+    update_mark_price();
+    int32_t bid_deals = 0;
+    int32_t ask_deals = 0;
+    for (const auto& deal : deals) {
+      (deal.dir == BID ? bid_deals : ask_deals) += 1;
+    }
+
+    const size_t variants_count = thresholds_.size();
+    const int64_t current_time = get_server_time().count();
+    const int64_t reset_period = std::chrono::duration_cast<Microseconds>(deals_reset_period_ms_).count();
+    for (size_t i = 0; i < variants_count; ++i) {
+      bid_counts_[i] += bid_deals;
+      ask_counts_[i] += ask_deals;
+      trade_flags_[i] = std::abs(ask_counts_[i] - bid_counts_[i]) >= thresholds_[i];
+    }
+
+    for (size_t i = 0; i < variants_count; ++i) {
+      if (trade_flags_[i]) {
+        const Dir dir_to_beat = ask_counts_[i] >= bid_counts_[i] ? ASK : BID;
+        const int64_t position = portfolios_.position(i);
+        if (std::abs(position + (dir_to_beat == BID ? 1 : -1)) <= kMaxPosition) {
+          const Price price_to_beat = trading_book_info.best_price(opposite_dir(dir_to_beat));
+          portfolios_.add_ioc_order(i, dir_to_beat, price_to_beat, 1, trading_book_info);
+        }
+      }
+    }
+
+    for (size_t i = 0; i < variants_count; ++i) {
+      const bool reset = trade_flags_[i] || current_time - last_reset_times_[i] >= reset_period;
+      last_reset_times_[i] = reset ? current_time : last_reset_times_[i];
+      bid_counts_[i] = reset ? 0 : bid_counts_[i];
+      ask_counts_[i] = reset ? 0 : ask_counts_[i];
+    }
+  }
+
+private:
+  // Максимальная позиция каждого варианта, как у стратегии по умолчанию.
+  static const int64_t kMaxPosition = 50;
+
+  static std::vector<int32_t> read_thresholds(const JsonValue& config) {
+    if (config.is_member("min_deals_count_diff_values")) {
+      return config["min_deals_count_diff_values"].as<std::vector<int32_t>>();
+    }
+    std::vector<int32_t> thresholds;
+    for (int32_t threshold = 10; threshold <= 200; threshold += 10) {
+      thresholds.push_back(threshold);
+    }
+    return thresholds;
+  }
+
+  // Запоминает среднюю цену стакана, если в нем есть обе стороны: у пустой стороны
+  // цена по умолчанию, и средняя цена не имеет смысла.
+  void update_mark_price() {
+    if (trading_book_info.best_volume(BID) > 0 && trading_book_info.best_volume(ASK) > 0) {
+      mark_price_ = trading_book_info.middle_price();
+    }
+  }
+
+  std::vector<int32_t> thresholds_;
+  Milliseconds deals_reset_period_ms_;
+
+  std::vector<int32_t> bid_counts_;
+  std::vector<int32_t> ask_counts_;
+  std::vector<int64_t> last_reset_times_;
+  std::vector<uint8_t> trade_flags_;
+  ShadowPortfolios portfolios_;
+  // Цена, по которой в конце дня оцениваются открытые позиции вариантов.
+  Price mark_price_;
+};
+
+REGISTER_CONTEST_STRATEGY(UserStrategy, deals_count_diff_sweep_strategy)
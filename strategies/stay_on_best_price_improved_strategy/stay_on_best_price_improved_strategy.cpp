@@ -17,7 +17,7 @@ public:
   // Вызывается при получении нового стакана торгового инструмента:
   // @order_book – новый стакан.
   void trading_book_update(const OrderBook& order_book) override {
-    auto our_orders = trading_book_info.orders();
+    auto& our_orders = trading_book_info.orders();
     for (Dir dir: {BID, ASK}) {
       const Price best_price = trading_book_info.best_price(dir);
       const Amount best_volume = trading_book_info.best_volume(dir);
@@ -27,9 +27,10 @@ public:
       } else {  // есть хотя бы одна наша активная заявка
         auto first_order = our_orders.orders_by_dir[dir][0];
         const bool on_best_price = first_order->price == best_price;
-        if (!on_best_price || !can_stay_on_best) {
+        if (!can_stay_on_best) {
           delete_order(first_order);
-          add_limit_order_if(dir, best_price, 1, can_stay_on_best);
+        } else if (!on_best_price) {
+          move_order(first_order, best_price, 1);
         }
       }
     }
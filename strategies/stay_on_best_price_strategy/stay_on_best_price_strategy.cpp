@@ -13,7 +13,7 @@ public:
   // Вызывается при получении нового стакана торгового инструмента:
   // @order_book – новый стакан.
   void trading_book_update(const OrderBook& order_book) override {
-    auto our_orders = trading_book_info.orders();
+    auto& our_orders = trading_book_info.orders();
     for (Dir dir: {BID, ASK}) {
       const Price best_price = trading_book_info.best_price(dir);
       const Amount amount = 1;
@@ -23,8 +23,7 @@ public:
         auto first_order = our_orders.orders_by_dir[dir][0];
         const bool on_best_price = first_order->price == best_price;
         if (!on_best_price) {  // наша заявка стоит, но не на текущей лучшей цене
-          delete_order(first_order);
-          add_limit_order(dir, best_price, amount);
+          move_order(first_order, best_price, amount);
         }
       }
     }